@@ -0,0 +1,14 @@
+#pragma once
+#include "Infrastructure.hxx"
+#include "glm/glm.hpp"
+
+namespace Meshes {
+	// nodes are stored depth first: the first child of an interior node immediately follows it.
+	// compiled mesh files hold them in this very layout, which is why the type sits apart from Mesh.hxx.
+	struct BVHNode {
+		field(Lower, glm::vec3{});
+		field(Offset, 0_u32); // first triangle (first triangle block once built) of a leaf, or the second child of an interior node
+		field(Upper, glm::vec3{});
+		field(Count, 0_u32); // triangles in a leaf, 0 for interior nodes
+	};
+}
\ No newline at end of file
@@ -0,0 +1,51 @@
+#pragma once
+#include "Filter.hxx"
+
+namespace Filter {
+	auto Denoise(auto&& NoisyImage, auto&& Normals, auto&& Depths, auto&& ObjectIndices, auto Iterations, auto&& ExecutionPolicy) {
+		constexpr auto B3SplineWeights = std::array{ 1. / 16, 1. / 4, 3. / 8, 1. / 4, 1. / 16 };
+		auto [NormalSensitivity, DepthSensitivity] = std::array{ 64., 32. };
+		using PixelType = std::decay_t<decltype(NoisyImage[0][0][0])>;
+		auto [Height, Width] = std::array{ static_cast<std::ptrdiff_t>(NoisyImage[0].Height), static_cast<std::ptrdiff_t>(NoisyImage[0].Width) };
+		auto DenoisedImage = [&] {
+			auto CopiedImage = Frame<PixelType, Layouts::Interleaved>{ Height, Width, 3 };
+			for (auto c : Range{ 3 })
+				for (auto y : Range{ Height })
+					for (auto x : Range{ Width })
+						CopiedImage[c][y][x] = NoisyImage[c][y][x];
+			return CopiedImage.Finalize();
+		}();
+		for (auto ColorSensitivity = 4.; auto Iteration : Range{ Iterations }) {
+			auto FilteredImage = Frame<PixelType, Layouts::Interleaved>{ Height, Width, 3 };
+			ForEachTile(ExecutionPolicy, Height, Width, [&, Step = 1_z << Iteration](auto y, auto x) {
+				auto [AccumulatedIntensity, AccumulatedWeight] = std::tuple{ std::array{ 0., 0., 0. }, 0. };
+				for (auto yOffset : Range{ -2, 3 })
+					for (auto xOffset : Range{ -2, 3 }) {
+						auto [yTap, xTap] = std::array{ y + yOffset * Step, x + xOffset * Step };
+						if (yTap < 0 || yTap >= Height || xTap < 0 || xTap >= Width || ObjectIndices[0][yTap][xTap] != ObjectIndices[0][y][x])
+							continue;
+						auto [ColorDistance, NormalDistance] = std::array{ 0., 0. };
+						for (auto c : Range{ 3 }) {
+							ColorDistance += std::pow(DenoisedImage[c][yTap][xTap] - DenoisedImage[c][y][x], 2);
+							NormalDistance += std::pow(Normals[c][yTap][xTap] - Normals[c][y][x], 2);
+						}
+						auto DepthDistance = std::abs(Depths[0][yTap][xTap] - Depths[0][y][x]) / Arithmetic::Max(Depths[0][y][x], 1e-6);
+						auto Weight = B3SplineWeights[yOffset + 2] * B3SplineWeights[xOffset + 2] * std::exp(-ColorDistance * ColorSensitivity - NormalDistance * NormalSensitivity - DepthDistance * DepthSensitivity);
+						for (auto c : Range{ 3 })
+							AccumulatedIntensity[c] += Weight * DenoisedImage[c][yTap][xTap];
+						AccumulatedWeight += Weight;
+					}
+				for (auto c : Range{ 3 })
+					FilteredImage[c][y][x] = AccumulatedIntensity[c] / AccumulatedWeight;
+			});
+			DenoisedImage = FilteredImage.Finalize();
+			ColorSensitivity *= 4;
+		}
+		auto PlanarImage = Frame<PixelType>{ Height, Width, 3 };
+		for (auto c : Range{ 3 })
+			for (auto y : Range{ Height })
+				for (auto x : Range{ Width })
+					PlanarImage[c][y][x] = DenoisedImage[c][y][x];
+		return PlanarImage.Finalize();
+	}
+}
\ No newline at end of file
@@ -1,13 +1,232 @@
 #pragma once
 #include "Frame.hxx"
 
+namespace Filter::ImplementationDetail {
+	constexpr auto UnboundedExtent = std::numeric_limits<std::ptrdiff_t>::max() / 4;
+
+	template<typename PixelType>
+	struct FootprintProbe {
+		field(Extents, static_cast<std::array<std::ptrdiff_t, 2>*>(nullptr));
+
+	private:
+		struct RowProbe {
+			field(Extents, static_cast<std::array<std::ptrdiff_t, 2>*>(nullptr));
+			field(yOffset, 0_z);
+
+		public:
+			auto operator[](std::integral auto x) const {
+				auto& [yExtent, xExtent] = *Extents;
+				yExtent = Arithmetic::Max(yExtent, std::abs(yOffset));
+				xExtent = Arithmetic::Max(xExtent, std::abs(static_cast<std::ptrdiff_t>(x)));
+				return PixelType{};
+			}
+		};
+
+	public:
+		auto operator[](std::integral auto y) const {
+			return RowProbe{ .Extents = Extents, .yOffset = y };
+		}
+		auto QueryCoordinates() const {
+			*Extents = { UnboundedExtent, UnboundedExtent };
+			return std::array{ 0_z, 0_z };
+		}
+		auto View(std::integral auto, std::integral auto) const {
+			*Extents = { UnboundedExtent, UnboundedExtent };
+			return *this;
+		}
+	};
+
+	// runs the kernel once on a probe to collect its taps, which assumes the taps do not depend on pixel values.
+	// a kernel that asks the probe for its coordinates or an offset view is unbounded, so every pixel takes the checked
+	// path; so is a kernel whose parameter type the probe does not convert to. a generic kernel is instantiated on the
+	// probe and must compile with it, which holds for anything restricted to [y][x], QueryCoordinates() and View().
+	template<typename PixelType>
+	auto MeasureFootprint(auto&& Kernel) {
+		auto Extents = std::array{ 0_z, 0_z };
+		if constexpr (requires { Kernel(FootprintProbe<PixelType>{}); })
+			Kernel(FootprintProbe<PixelType>{ .Extents = &Extents });
+		else
+			Extents = { UnboundedExtent, UnboundedExtent };
+		return Extents;
+	}
+}
+
+namespace Filter::ImplementationDetail {
+	template<typename PixelType, bool Checked>
+	struct RegionView {
+		field(TargetCanvas, CanvasProxy<const PixelType, Layouts::Planar>{});
+		field(yOrigin, 0_z);
+		field(xOrigin, 0_z);
+		field(Height, 0_z);
+		field(Width, 0_z);
+		field(yOffset, 0_z);
+		field(xOffset, 0_z);
+
+	private:
+		struct RegionAccess {
+			field(TargetView, static_cast<const RegionView*>(nullptr));
+			field(yAbsolute, 0_z);
+
+		public:
+			auto operator[](std::integral auto x) const {
+				auto [yRemapped, xRemapped] = std::array{ yAbsolute, x + TargetView->xOffset };
+				if (Checked && (yRemapped < 0 || xRemapped < 0 || yRemapped >= TargetView->Height || xRemapped >= TargetView->Width))
+					std::tie(yRemapped, xRemapped) = std::tuple{ RemappingFunctions::Reflect(yRemapped, TargetView->Height), RemappingFunctions::Reflect(xRemapped, TargetView->Width) };
+				return TargetView->TargetCanvas[yRemapped - TargetView->yOrigin][xRemapped - TargetView->xOrigin];
+			}
+		};
+
+	public:
+		auto operator[](std::integral auto y) const {
+			return RegionAccess{ .TargetView = this, .yAbsolute = y + yOffset };
+		}
+		auto QueryCoordinates() const {
+			return std::array{ yOffset, xOffset };
+		}
+		auto View(std::integral auto y, std::integral auto x) const {
+			auto OffsetView = *this;
+			OffsetView.yOffset += y;
+			OffsetView.xOffset += x;
+			return OffsetView;
+		}
+	};
+}
+
 namespace Filter {
+	auto ForEachTileRegion(auto&& ExecutionPolicy, auto Height, auto Width, std::ptrdiff_t TileSize, auto&& RegionProcessor) {
+		auto Tiles = std::vector<std::array<std::ptrdiff_t, 4>>{};
+		for (auto y : Range{ 0_z, static_cast<std::ptrdiff_t>(Height), TileSize })
+			for (auto x : Range{ 0_z, static_cast<std::ptrdiff_t>(Width), TileSize })
+				Tiles.push_back({ y, x, Arithmetic::Min(TileSize, static_cast<std::ptrdiff_t>(Height) - y), Arithmetic::Min(TileSize, static_cast<std::ptrdiff_t>(Width) - x) });
+		std::for_each(ExecutionPolicy, Tiles.begin(), Tiles.end(), [&](auto Tile) {
+			auto [yTile, xTile, TileHeight, TileWidth] = Tile;
+			RegionProcessor(yTile, xTile, TileHeight, TileWidth);
+		});
+	}
+	auto ForEachTile(auto&& ExecutionPolicy, auto Height, auto Width, auto&& PixelProcessor) {
+		ForEachTileRegion(ExecutionPolicy, Height, Width, 64, [&](auto yTile, auto xTile, auto TileHeight, auto TileWidth) {
+			for (auto y : Range{ yTile, yTile + TileHeight })
+				for (auto x : Range{ xTile, xTile + TileWidth })
+					PixelProcessor(y, x);
+		});
+	}
+
+	template<typename KernelType, typename SourceType>
+	struct Expression;
+	template<typename>
+	constexpr auto IsExpression = false;
+	template<typename KernelType, typename SourceType>
+	constexpr auto IsExpression<Expression<KernelType, SourceType>> = true;
+	namespace ImplementationDetail {
+		template<typename SourceType>
+		auto SourcePixelOf() {
+			if constexpr (IsExpression<std::decay_t<SourceType>>)
+				return typename std::decay_t<SourceType>::PixelType{};
+			else
+				return std::decay_t<decltype(std::declval<SourceType>()[0][0][0])>{};
+		}
+	}
+
+	// Kernel * Frame builds one of these instead of a frame. Evaluate() walks the output in tiles and, for each
+	// tile, evaluates the inner stages only over the tile grown by the outer kernels' footprints. the outermost stage
+	// writes straight into the output frame, and each inner stage into a scratch region its caller keeps per thread.
+	template<typename KernelType, typename SourceType>
+	struct Expression {
+		KernelType Kernel;
+		SourceType Source;
+
+	private:
+		static constexpr auto isLeaf = IsExpression<std::decay_t<SourceType>> == false;
+		static constexpr auto TileSize = 64_z;
+		static constexpr auto MaximumFusableRadius = TileSize;
+		using SourcePixelType = decltype(ImplementationDetail::SourcePixelOf<SourceType>());
+
+	public:
+		// inner stages store what they evaluate in the pixel type of the frame at the bottom of the chain, the outermost
+		// stage in the pixel type of the output frame
+		using PixelType = SourcePixelType;
+
+		auto Dimensions() const {
+			if constexpr (isLeaf)
+				return std::array{ static_cast<std::ptrdiff_t>(Source.PlaneCount), static_cast<std::ptrdiff_t>(Source[0].Height), static_cast<std::ptrdiff_t>(Source[0].Width) };
+			else
+				return Source.Dimensions();
+		}
+		auto Footprint() const {
+			return ImplementationDetail::MeasureFootprint<SourcePixelType>(Kernel);
+		}
+		auto isFusable() const -> bool {
+			if (auto [yRadius, xRadius] = Footprint(); yRadius > MaximumFusableRadius || xRadius > MaximumFusableRadius)
+				return false;
+			else if constexpr (isLeaf)
+				return true;
+			else
+				return Source.isFusable();
+		}
+		// TargetRow(c, y) points at the pixel of row y in plane c where the region starts
+		auto EvaluateRegion(std::ptrdiff_t yRegion, std::ptrdiff_t xRegion, std::ptrdiff_t RegionHeight, std::ptrdiff_t RegionWidth, bool isTiled, auto&& TargetRow) const {
+			auto [PlaneCount, Height, Width] = Dimensions();
+			auto [yRadius, xRadius] = Footprint();
+			auto EvaluateRows = [&](auto&& CheckedView, auto&& UncheckedView) {
+				for (auto c : Range{ PlaneCount })
+					for (auto y : Range{ yRegion, yRegion + RegionHeight }) {
+						auto [InteriorStartpoint, InteriorEndpoint] = std::array{ Arithmetic::Max(xRadius, xRegion), Arithmetic::Min(Width - xRadius, xRegion + RegionWidth) };
+						if (y < yRadius || y + yRadius >= Height)
+							InteriorStartpoint = InteriorEndpoint = xRegion + RegionWidth;
+						InteriorEndpoint = Arithmetic::Max(InteriorStartpoint, InteriorEndpoint);
+						auto EvaluatedRow = TargetRow(c, y);
+						for (auto x : Range{ xRegion, InteriorStartpoint })
+							EvaluatedRow[x - xRegion] = Kernel(CheckedView(c, y, x));
+						for (auto x : Range{ InteriorStartpoint, InteriorEndpoint })
+							EvaluatedRow[x - xRegion] = Kernel(UncheckedView(c, y, x));
+						for (auto x : Range{ InteriorEndpoint, xRegion + RegionWidth })
+							EvaluatedRow[x - xRegion] = Kernel(CheckedView(c, y, x));
+					}
+			};
+			if constexpr (isLeaf)
+				EvaluateRows([&](auto c, auto y, auto x) { return Source[c].View(y, x); }, [&](auto c, auto y, auto x) { return Source[c].UncheckedView(y, x); });
+			else {
+				auto [ySource, xSource] = std::array{ Arithmetic::Max(yRegion - yRadius, 0_z), Arithmetic::Max(xRegion - xRadius, 0_z) };
+				auto [SourceHeight, SourceWidth] = std::array{ Arithmetic::Min(yRegion + RegionHeight + yRadius, Height) - ySource, Arithmetic::Min(xRegion + RegionWidth + xRadius, Width) - xSource };
+				// tiles are all about the same size, so a thread's scratch stops growing after its first tile. a chain
+				// evaluated as one whole-frame region has no later tile to reuse it for and frees it when done.
+				thread_local auto TileScratch = std::vector<PixelType>{};
+				auto RegionScratch = std::vector<PixelType>{};
+				auto& Scratch = isTiled ? TileScratch : RegionScratch;
+				if (auto ScratchSize = static_cast<std::size_t>(PlaneCount * SourceHeight * SourceWidth); Scratch.size() < ScratchSize)
+					Scratch.resize(ScratchSize);
+				Source.EvaluateRegion(ySource, xSource, SourceHeight, SourceWidth, isTiled, [&](auto c, auto y) { return Scratch.data() + (c * SourceHeight + y - ySource) * SourceWidth; });
+				auto ViewSourceRegion = [&]<bool Checked>(auto c, auto y, auto x) {
+					return ImplementationDetail::RegionView<PixelType, Checked>{
+						.TargetCanvas = { .Height = static_cast<std::size_t>(SourceHeight), .Width = static_cast<std::size_t>(SourceWidth), .Stride = SourceWidth, .Data = Scratch.data() + c * SourceHeight * SourceWidth },
+						.yOrigin = ySource, .xOrigin = xSource, .Height = Height, .Width = Width, .yOffset = y, .xOffset = x
+					};
+				};
+				EvaluateRows([&](auto c, auto y, auto x) { return ViewSourceRegion.template operator()<true>(c, y, x); }, [&](auto c, auto y, auto x) { return ViewSourceRegion.template operator()<false>(c, y, x); });
+			}
+		}
+		template<typename OutputPixelType = PixelType>
+		auto Evaluate(auto&& ExecutionPolicy) const {
+			auto [PlaneCount, Height, Width] = Dimensions();
+			auto EvaluatedFrame = Frame<OutputPixelType>{ Height, Width, PlaneCount };
+			auto isTiled = isFusable();
+			ForEachTileRegion(ExecutionPolicy, Height, Width, isTiled ? TileSize : Arithmetic::Max(Height, Width), [&](auto yTile, auto xTile, auto TileHeight, auto TileWidth) {
+				EvaluateRegion(yTile, xTile, TileHeight, TileWidth, isTiled, [&](auto c, auto y) { return EvaluatedFrame[c][y] + xTile; });
+			});
+			return EvaluatedFrame.Finalize();
+		}
+		template<typename OutputPixelType = PixelType>
+		auto Evaluate() const {
+			return Evaluate<OutputPixelType>(std::execution::seq);
+		}
+	};
+
 	auto operator*(auto&& Kernel, auto&& SourceFrame) requires requires { { Kernel(SourceFrame[0].View(0, 0)) }->std::convertible_to<std::decay_t<decltype(SourceFrame[0][0][0])>>; } {
-		auto ProcessedFrame = Frame{ SourceFrame[0].Height, SourceFrame[0].Width, SourceFrame.PlaneCount };
-		for (auto c : Range{ SourceFrame.PlaneCount })
-			for (auto y : Range{ SourceFrame[c].Height })
-				for (auto x : Range{ SourceFrame[c].Width })
-					ProcessedFrame[c][y][x] = Kernel(SourceFrame[c].View(y, x));
-		return ProcessedFrame.Finalize();
+		using SourceType = std::conditional_t<std::is_lvalue_reference_v<decltype(SourceFrame)>, decltype(SourceFrame), std::decay_t<decltype(SourceFrame)>>;
+		return Expression<std::decay_t<decltype(Kernel)>, SourceType>{ Forward(Kernel), Forward(SourceFrame) };
+	}
+	auto operator*(auto&& Kernel, auto&& SourceExpression) requires IsExpression<std::decay_t<decltype(SourceExpression)>> {
+		using SourceType = std::conditional_t<std::is_lvalue_reference_v<decltype(SourceExpression)>, decltype(SourceExpression), std::decay_t<decltype(SourceExpression)>>;
+		return Expression<std::decay_t<decltype(Kernel)>, SourceType>{ Forward(Kernel), Forward(SourceExpression) };
 	}
 }
\ No newline at end of file
@@ -7,32 +7,51 @@ namespace RemappingFunctions {
 		return x;
 	};
 	constexpr auto Reflect = [](auto x, auto Bound) {
-		while (x < 0 || x >= Bound) {
-			x = std::abs(x);
-			x -= Bound - 1;
-			x = -std::abs(x);
-			x += Bound - 1;
+		if (auto Period = 2 * (static_cast<decltype(x)>(Bound) - 1); Period > 0) {
+			x = std::abs(x) % Period;
+			return x < static_cast<decltype(x)>(Bound) ? x : Period - x;
 		}
-		return x;
+		return decltype(x){ 0 };
 	};
+	struct Polymorphic {};
+}
+
+namespace Filter::Layouts {
+	struct Planar {};
+	struct Interleaved {};
 }
 
 namespace Filter::ImplementationDetail {
-	template<typename PixelType>
+	template<typename PixelType, typename LayoutType>
 	struct CanvasProxy {
 		field(Height, 0_uz);
 		field(Width, 0_uz);
 		field(Stride, 0_z);
 		field(Data, static_cast<PixelType*>(nullptr));
+		field(PixelStride, 1_z);
+
+	private:
+		struct InterleavedRow {
+			field(Data, static_cast<PixelType*>(nullptr));
+			field(PixelStride, 1_z);
+
+		public:
+			auto& operator[](std::integral auto x) const {
+				return Data[x * PixelStride];
+			}
+		};
 
 	public:
 		auto operator[](auto y) const {
-			return Data + y * Stride;
+			if constexpr (std::same_as<LayoutType, Layouts::Interleaved>)
+				return InterleavedRow{ .Data = Data + y * Stride, .PixelStride = PixelStride };
+			else
+				return Data + y * Stride;
 		}
 	};
 
-	template<typename PixelType>
-	struct Plane : CanvasProxy<PixelType> {
+	template<typename PixelType, typename LayoutType, typename RemappingPolicy>
+	struct Plane : CanvasProxy<PixelType, LayoutType> {
 	private:
 		using EmptyType = struct {};
 		struct ExistentialTypeForRemappingFunction {
@@ -62,10 +81,12 @@ namespace Filter::ImplementationDetail {
 	public:
 		static constexpr auto Readonly = std::is_const_v<PixelType>;
 		static inline auto DefaultRemappingFunction = [] {
-			if constexpr (auto PolymorphicRemappingFunction = ExistentialTypeForRemappingFunction{}; Readonly)
+			if constexpr (auto PolymorphicRemappingFunction = ExistentialTypeForRemappingFunction{}; Readonly == false)
+				return EmptyType{};
+			else if constexpr (std::same_as<RemappingPolicy, RemappingFunctions::Polymorphic>)
 				return PolymorphicRemappingFunction = RemappingFunctions::Reflect;
 			else
-				return EmptyType{};
+				return RemappingPolicy{};
 		}();
 
 	public:
@@ -81,7 +102,7 @@ namespace Filter::ImplementationDetail {
 		public:
 			auto operator[](std::integral auto x) const {
 				if (auto xAbsolute = x + xOffset; xAbsolute < 0 || yAbsolute < 0 || xAbsolute >= TargetPlane->Width || yAbsolute >= TargetPlane->Height) {
-					auto [yRemapped, xRemapped] = TargetPlane->OutOfBoundsRemapping(yAbsolute, xAbsolute, TargetPlane->Height, TargetPlane->Width);
+					auto [yRemapped, xRemapped] = TargetPlane->Remap(yAbsolute, xAbsolute);
 					return TargetPlane->DirectAccess()[yRemapped][xRemapped];
 				}
 				else [[likely]]
@@ -107,27 +128,66 @@ namespace Filter::ImplementationDetail {
 			}
 		};
 
+	private:
+		struct InteriorRow {
+			decltype(std::declval<const CanvasProxy<PixelType, LayoutType>&>()[0_z]) Row;
+			field(xOffset, 0_z);
+
+		public:
+			auto operator[](std::integral auto x) const {
+				return Row[x + xOffset];
+			}
+		};
+		struct InteriorView {
+			field(TargetPlane, static_cast<const Plane*>(nullptr));
+			field(yOffset, 0_z);
+			field(xOffset, 0_z);
+
+		public:
+			auto operator[](std::integral auto y) const {
+				return InteriorRow{ .Row = TargetPlane->DirectAccess()[y + yOffset], .xOffset = xOffset };
+			}
+			auto QueryCoordinates() const {
+				return std::array{ yOffset, xOffset };
+			}
+			auto View(std::integral auto y, std::integral auto x) const {
+				return InteriorView{ .TargetPlane = TargetPlane, .yOffset = yOffset + y, .xOffset = xOffset + x };
+			}
+		};
+
+	private:
+		auto Remap(std::ptrdiff_t y, std::ptrdiff_t x) const {
+			auto [Height, Width] = std::array{ static_cast<std::ptrdiff_t>(this->Height), static_cast<std::ptrdiff_t>(this->Width) };
+			if constexpr (requires { { OutOfBoundsRemapping(y, x, this->Height, this->Width) }->std::same_as<std::array<std::ptrdiff_t, 2>>; })
+				return OutOfBoundsRemapping(y, x, this->Height, this->Width);
+			else
+				return std::array{ OutOfBoundsRemapping(y, Height), OutOfBoundsRemapping(x, Width) };
+		}
+
 	public:
 		auto operator[](std::integral auto y) const {
 			if constexpr (Readonly)
 				return RemappedAccess{ .TargetPlane = this, .yAbsolute = y };
 			else
-				return CanvasProxy<PixelType>::operator[](y);
+				return CanvasProxy<PixelType, LayoutType>::operator[](y);
 		}
 		auto View(std::integral auto y, std::integral auto x) const requires Readonly {
 			return OffsetView{.TargetPlane = this, .yOffset = y, .xOffset = x };
 		}
+		auto UncheckedView(std::integral auto y, std::integral auto x) const requires Readonly {
+			return InteriorView{ .TargetPlane = this, .yOffset = y, .xOffset = x };
+		}
 		auto& DirectAccess() const requires Readonly {
-			return static_cast<const CanvasProxy<PixelType>&>(*this);
+			return static_cast<const CanvasProxy<PixelType, LayoutType>&>(*this);
 		}
 	};
 }
 
 namespace Filter {
-	template<typename PixelType = double>
+	template<typename PixelType = float, typename LayoutType = Layouts::Planar, typename RemappingPolicy = std::decay_t<decltype(RemappingFunctions::Reflect)>>
 	struct Frame {
 	private:
-		using PlaneType = ImplementationDetail::Plane<PixelType>;
+		using PlaneType = ImplementationDetail::Plane<PixelType, LayoutType, RemappingPolicy>;
 
 	public:
 		static constexpr auto Readonly = std::is_const_v<PixelType>;
@@ -156,10 +216,13 @@ namespace Filter {
 	public:
 		auto RefreshPlanes(std::integral auto Height, std::integral auto Width) {
 			for (auto Index : Range{ this->PlaneCount })
-				Planes[Index] = PlaneType{ Height, Width, Width, Storage.data() + Index * Height * Width };
+				if constexpr (std::same_as<LayoutType, Layouts::Interleaved>)
+					Planes[Index] = PlaneType{ Height, Width, static_cast<std::ptrdiff_t>(Width * PlaneCount), Storage.data() + Index, static_cast<std::ptrdiff_t>(PlaneCount) };
+				else
+					Planes[Index] = PlaneType{ Height, Width, Width, Storage.data() + Index * Height * Width };
 		}
 		auto Finalize() requires (Readonly == false) {
-			auto FinalizedFrame = Frame<const std::decay_t<PixelType>>{};
+			auto FinalizedFrame = Frame<const std::decay_t<PixelType>, LayoutType, RemappingPolicy>{};
 			FinalizedFrame.PlaneCount = this->PlaneCount;
 			std::swap(FinalizedFrame.Storage, this->Storage);
 			FinalizedFrame.RefreshPlanes(this->Planes[0].Height, this->Planes[0].Width);
@@ -0,0 +1,35 @@
+#pragma once
+#include "Infrastructure.hxx"
+#include <bit>
+
+struct Half {
+	field(Bits, std::uint16_t{});
+
+public:
+	Half() = default;
+	Half(float x) {
+		auto FloatBits = std::bit_cast<std::uint32_t>(x);
+		auto Sign = static_cast<std::uint16_t>((FloatBits >> 16) & 0x8000);
+		FloatBits &= 0x7FFFFFFF;
+		if (FloatBits >= 0x7F800000)
+			Bits = static_cast<std::uint16_t>(Sign | 0x7C00 | (FloatBits > 0x7F800000 ? 0x200 : 0));
+		else if (FloatBits >= 0x477FF000)
+			Bits = static_cast<std::uint16_t>(Sign | 0x7C00);
+		else if (FloatBits < 0x38800000)
+			Bits = static_cast<std::uint16_t>(Sign | (std::bit_cast<std::uint32_t>(std::bit_cast<float>(FloatBits) + 0.5f) - 0x3F000000));
+		else
+			Bits = static_cast<std::uint16_t>(Sign | ((FloatBits + 0xC8000FFF + ((FloatBits >> 13) & 1)) >> 13));
+	}
+
+public:
+	operator float() const {
+		auto Sign = static_cast<std::uint32_t>(Bits & 0x8000) << 16;
+		auto [Exponent, Mantissa] = std::array{ Bits >> 10 & 0x1F, Bits & 0x3FF };
+		if (Exponent == 0x1F)
+			return std::bit_cast<float>(Sign | 0x7F800000 | Mantissa << 13);
+		else if (Exponent == 0)
+			return std::bit_cast<float>(Sign | std::bit_cast<std::uint32_t>(Mantissa * 0x1p-24f));
+		else
+			return std::bit_cast<float>(Sign | (Exponent + 112) << 23 | Mantissa << 13);
+	}
+};
\ No newline at end of file
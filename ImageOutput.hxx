@@ -0,0 +1,249 @@
+#pragma once
+#include "Frame.hxx"
+#include "Half.hxx"
+#include <fstream>
+#include <optional>
+#include <zlib.h>
+
+namespace ImageOutput {
+	auto AppendLittleEndian(auto& Buffer, auto Value) {
+		using UnsignedType = std::conditional_t<sizeof(Value) == 2, std::uint16_t, std::conditional_t<sizeof(Value) == 4, std::uint32_t, std::uint64_t>>;
+		for (auto Bits = std::bit_cast<UnsignedType>(Value); auto _ : Range{ sizeof(Value) }) {
+			Buffer.push_back(static_cast<char>(Bits & 0xFF));
+			Bits >>= 8;
+		}
+	}
+	auto WritePFM(const std::string& Path, auto&& RenderedImage) {
+		auto [Height, Width] = std::array{ static_cast<std::ptrdiff_t>(RenderedImage[0].Height), static_cast<std::ptrdiff_t>(RenderedImage[0].Width) };
+		auto OutputFile = std::ofstream{ Path, std::ios::binary };
+		auto Header = "PF\n" + std::to_string(Width) + " " + std::to_string(Height) + "\n-1.0\n";
+		OutputFile.write(Header.data(), std::ssize(Header));
+		for (auto Scanline = std::string{}; auto y : Range{ Height - 1, -1, -1 }) {
+			Scanline.clear();
+			for (auto x : Range{ Width })
+				for (auto c : Range{ 3 })
+					AppendLittleEndian(Scanline, static_cast<float>(RenderedImage[c][y][x]));
+			OutputFile.write(Scanline.data(), std::ssize(Scanline));
+		}
+		return OutputFile.good();
+	}
+	auto WriteEXR(const std::string& Path, auto&& RenderedImage) {
+		auto [Height, Width] = std::array{ static_cast<std::ptrdiff_t>(RenderedImage[0].Height), static_cast<std::ptrdiff_t>(RenderedImage[0].Width) };
+		auto OutputFile = std::ofstream{ Path, std::ios::binary };
+		auto Header = std::string{};
+		auto AppendAttribute = [&](std::string_view Name, std::string_view Type, std::string_view Value) {
+			Header.append(Name).push_back('\0');
+			Header.append(Type).push_back('\0');
+			AppendLittleEndian(Header, static_cast<std::int32_t>(Value.size()));
+			Header.append(Value);
+		};
+		auto Encode = [](auto... Values) {
+			auto Buffer = std::string{};
+			(AppendLittleEndian(Buffer, Values), ...);
+			return Buffer;
+		};
+		AppendLittleEndian(Header, 20000630);
+		AppendLittleEndian(Header, 2);
+		AppendAttribute("channels", "chlist", [&] {
+			auto ChannelList = std::string{};
+			for (auto Channel : { "B", "G", "R" }) {
+				ChannelList.append(Channel).push_back('\0');
+				ChannelList += Encode(1, 0, 1, 1);
+			}
+			return ChannelList + '\0';
+		}());
+		AppendAttribute("compression", "compression", std::string(1, '\0'));
+		AppendAttribute("dataWindow", "box2i", Encode(0, 0, static_cast<std::int32_t>(Width - 1), static_cast<std::int32_t>(Height - 1)));
+		AppendAttribute("displayWindow", "box2i", Encode(0, 0, static_cast<std::int32_t>(Width - 1), static_cast<std::int32_t>(Height - 1)));
+		AppendAttribute("lineOrder", "lineOrder", std::string(1, '\0'));
+		AppendAttribute("pixelAspectRatio", "float", Encode(1.f));
+		AppendAttribute("screenWindowCenter", "v2f", Encode(0.f, 0.f));
+		AppendAttribute("screenWindowWidth", "float", Encode(1.f));
+		Header.push_back('\0');
+		auto [ScanlineSize, FirstScanlineOffset] = std::array{ 2 * 3 * Width, std::ssize(Header) + 8 * Height };
+		for (auto y : Range{ Height })
+			AppendLittleEndian(Header, static_cast<std::uint64_t>(FirstScanlineOffset + y * (8 + ScanlineSize)));
+		OutputFile.write(Header.data(), std::ssize(Header));
+		for (auto Scanline = std::string{}; auto y : Range{ Height }) {
+			Scanline = Encode(static_cast<std::int32_t>(y), static_cast<std::int32_t>(ScanlineSize));
+			for (auto c : { 2, 1, 0 })
+				for (auto x : Range{ Width })
+					AppendLittleEndian(Scanline, Half{ static_cast<float>(RenderedImage[c][y][x]) }.Bits);
+			OutputFile.write(Scanline.data(), std::ssize(Scanline));
+		}
+		return OutputFile.good();
+	}
+
+	struct PPMWriter {
+		field(OutputFile, std::ofstream{});
+
+	public:
+		PPMWriter(const std::string& Path, std::integral auto Height, std::integral auto Width) : OutputFile{ Path, std::ios::binary } {
+			auto Header = "P6\n" + std::to_string(Width) + " " + std::to_string(Height) + "\n255\n";
+			OutputFile.write(Header.data(), std::ssize(Header));
+		}
+
+	public:
+		auto Append(auto&& Canvas, std::integral auto Height, std::integral auto Width) {
+			for (auto Scanline = std::string(3 * Width, '\0'); auto y : Range{ Height }) {
+				for (auto Pixels = reinterpret_cast<const char*>(Canvas[y]); auto x : Range{ Width })
+					std::copy_n(Pixels + 4 * x, 3, Scanline.data() + 3 * x);
+				OutputFile.write(Scanline.data(), std::ssize(Scanline));
+			}
+		}
+		auto Finish() {
+			OutputFile.flush();
+			return OutputFile.good();
+		}
+	};
+
+	struct PNGWriter {
+		static constexpr auto FilterTypes = std::array{ "none"sv, "sub"sv, "up"sv, "average"sv, "paeth"sv };
+		field(OutputFile, std::ofstream{});
+		field(CompressionLevel, Z_DEFAULT_COMPRESSION);
+		field(FilterMethod, "adaptive"s);
+		field(enableParallelism, false);
+		field(PreviousScanline, std::string{});
+		field(PreviousFilteredTail, std::string{});
+		field(Checksum, adler32(0, nullptr, 0));
+
+	public:
+		PNGWriter(const std::string& Path, std::integral auto Height, std::integral auto Width) : OutputFile{ Path, std::ios::binary } {
+			auto Header = EncodeBigEndian(static_cast<std::uint32_t>(Width)) + EncodeBigEndian(static_cast<std::uint32_t>(Height));
+			Header += std::string{ '\x08', '\x02', '\0', '\0', '\0' };
+			OutputFile.write("\x89PNG\r\n\x1A\n", 8);
+			WriteChunk("IHDR", Header);
+			WriteChunk("IDAT", "\x78\x9C");
+			PreviousScanline = std::string(3 * Width, '\0');
+		}
+
+	private:
+		static auto EncodeBigEndian(std::uint32_t Bits) {
+			auto Buffer = std::string{};
+			for (auto Shift : { 24, 16, 8, 0 })
+				Buffer.push_back(static_cast<char>(Bits >> Shift & 0xFF));
+			return Buffer;
+		}
+		auto WriteChunk(std::string_view Type, std::string_view Data) {
+			auto ChunkChecksum = crc32(0, reinterpret_cast<const Bytef*>(Type.data()), 4);
+			if (Data.empty() == false)
+				ChunkChecksum = crc32(ChunkChecksum, reinterpret_cast<const Bytef*>(Data.data()), static_cast<uInt>(Data.size()));
+			auto [Length, Trailer] = std::tuple{ EncodeBigEndian(static_cast<std::uint32_t>(Data.size())), EncodeBigEndian(static_cast<std::uint32_t>(ChunkChecksum)) };
+			OutputFile.write(Length.data(), 4);
+			OutputFile.write(Type.data(), 4);
+			OutputFile.write(Data.data(), std::ssize(Data));
+			OutputFile.write(Trailer.data(), 4);
+		}
+		static auto FilterScanline(const std::uint8_t* Scanline, const std::uint8_t* PreviousScanline, std::ptrdiff_t Length, std::uint8_t FilterType, std::uint8_t* Destination) {
+			auto Predict = [&](auto x) {
+				auto [a, b, c] = std::array<int, 3>{ x >= 3 ? Scanline[x - 3] : 0, PreviousScanline[x], x >= 3 ? PreviousScanline[x - 3] : 0 };
+				if (FilterType == 1)
+					return a;
+				else if (FilterType == 2)
+					return b;
+				else if (FilterType == 3)
+					return (a + b) / 2;
+				else if (auto [pa, pb, pc] = std::array{ std::abs(b - c), std::abs(a - c), std::abs(a + b - 2 * c) }; FilterType == 4)
+					return pa <= pb && pa <= pc ? a : pb <= pc ? b : c;
+				else
+					return 0;
+			};
+			Destination[0] = FilterType;
+			for (auto x : Range{ Length })
+				Destination[x + 1] = static_cast<std::uint8_t>(Scanline[x] - Predict(x));
+		}
+		auto FilterScanline(const std::uint8_t* Scanline, const std::uint8_t* PreviousScanline, std::ptrdiff_t Length, std::uint8_t* Destination) const {
+			if (FilterMethod != "adaptive") {
+				auto FilterType = std::find(FilterTypes.begin(), FilterTypes.end(), FilterMethod) - FilterTypes.begin();
+				return FilterScanline(Scanline, PreviousScanline, Length, static_cast<std::uint8_t>(FilterType), Destination);
+			}
+			auto [Candidate, MinimumCost] = std::tuple{ std::vector<std::uint8_t>(Length + 1), std::numeric_limits<std::ptrdiff_t>::max() };
+			for (auto FilterType : Range{ 5 }) {
+				FilterScanline(Scanline, PreviousScanline, Length, static_cast<std::uint8_t>(FilterType), Candidate.data());
+				if (auto Cost = std::accumulate(Candidate.begin() + 1, Candidate.end(), 0_z, [](auto Sum, auto x) { return Sum + std::abs(static_cast<std::int8_t>(x)); }); Cost < MinimumCost) {
+					MinimumCost = Cost;
+					std::copy(Candidate.begin(), Candidate.end(), Destination);
+				}
+			}
+		}
+		// runs inside the parallel block loop, where an exception would terminate, so failure is reported as an empty optional
+		auto CompressBlock(std::string_view Data, std::string_view Dictionary) const {
+			auto CompressedStream = z_stream{};
+			if (deflateInit2(&CompressedStream, CompressionLevel, Z_DEFLATED, -15, 8, Z_DEFAULT_STRATEGY) != Z_OK)
+				return std::optional<std::string>{};
+			auto CompressedBlock = std::optional{ std::string(deflateBound(&CompressedStream, static_cast<uLong>(Data.size())) + 64, '\0') };
+			if (Dictionary.empty() == false && deflateSetDictionary(&CompressedStream, reinterpret_cast<const Bytef*>(Dictionary.data()), static_cast<uInt>(Dictionary.size())) != Z_OK)
+				CompressedBlock.reset();
+			else {
+				CompressedStream.next_in = reinterpret_cast<Bytef*>(const_cast<char*>(Data.data()));
+				CompressedStream.avail_in = static_cast<uInt>(Data.size());
+				CompressedStream.next_out = reinterpret_cast<Bytef*>(CompressedBlock->data());
+				CompressedStream.avail_out = static_cast<uInt>(CompressedBlock->size());
+				if (auto Status = deflate(&CompressedStream, Z_SYNC_FLUSH); Status != Z_OK || CompressedStream.avail_in != 0)
+					CompressedBlock.reset();
+				else
+					CompressedBlock->resize(CompressedStream.total_out);
+			}
+			deflateEnd(&CompressedStream);
+			return CompressedBlock;
+		}
+
+	public:
+		auto Append(auto&& Canvas, std::integral auto Height, std::integral auto Width) {
+			constexpr auto WindowSize = 1_z << 15;
+			if (CompressionLevel < Z_DEFAULT_COMPRESSION || CompressionLevel > Z_BEST_COMPRESSION)
+				throw std::runtime_error{ "PNG compression level " + std::to_string(CompressionLevel) + " is outside [-1, 9]!" };
+			if (FilterMethod != "adaptive" && std::find(FilterTypes.begin(), FilterTypes.end(), FilterMethod) == FilterTypes.end())
+				throw std::runtime_error{ "Unrecognized PNG filter method " + FilterMethod + "!" };
+			auto [ScanlineSize, FilteredScanlineSize] = std::array{ 3 * static_cast<std::ptrdiff_t>(Width), 1 + 3 * static_cast<std::ptrdiff_t>(Width) };
+			auto ScanlinesPerBlock = Arithmetic::Max((1_z << 17) / FilteredScanlineSize, 1_z);
+			auto [Scanlines, FilteredScanlines] = std::tuple{ std::string(ScanlineSize * Height, '\0'), std::string(FilteredScanlineSize * Height, '\0') };
+			auto Blocks = std::vector<std::array<std::ptrdiff_t, 2>>{};
+			for (auto y : Range{ 0_z, static_cast<std::ptrdiff_t>(Height), ScanlinesPerBlock })
+				Blocks.push_back({ y, Arithmetic::Min(y + ScanlinesPerBlock, static_cast<std::ptrdiff_t>(Height)) });
+			auto ForEachBlock = [&](auto&& BlockProcessor) {
+				if (enableParallelism)
+					std::for_each(std::execution::par, Blocks.begin(), Blocks.end(), BlockProcessor);
+				else
+					std::for_each(std::execution::seq, Blocks.begin(), Blocks.end(), BlockProcessor);
+			};
+			auto ScanlineAt = [&](auto y) {
+				return reinterpret_cast<const std::uint8_t*>(y < 0 ? PreviousScanline.data() : Scanlines.data() + y * ScanlineSize);
+			};
+			ForEachBlock([&](auto Block) {
+				for (auto [yStartpoint, yEndpoint] = Block; auto y : Range{ yStartpoint, yEndpoint })
+					for (auto Pixels = reinterpret_cast<const char*>(Canvas[y]); auto x : Range{ Width })
+						std::copy_n(Pixels + 4 * x, 3, Scanlines.data() + y * ScanlineSize + 3 * x);
+			});
+			ForEachBlock([&](auto Block) {
+				for (auto [yStartpoint, yEndpoint] = Block; auto y : Range{ yStartpoint, yEndpoint })
+					FilterScanline(ScanlineAt(y), ScanlineAt(y - 1), ScanlineSize, reinterpret_cast<std::uint8_t*>(FilteredScanlines.data() + y * FilteredScanlineSize));
+			});
+			auto [CompressedBlocks, BlockChecksums] = std::tuple{ std::vector<std::optional<std::string>>(Blocks.size()), std::vector<uLong>(Blocks.size()) };
+			ForEachBlock([&](auto& Block) {
+				auto Index = &Block - Blocks.data();
+				auto [BlockStartpoint, BlockEndpoint] = std::array{ Block[0] * FilteredScanlineSize, Block[1] * FilteredScanlineSize };
+				auto Data = std::string_view{ FilteredScanlines }.substr(BlockStartpoint, BlockEndpoint - BlockStartpoint);
+				auto Dictionary = Index == 0 ? std::string_view{ PreviousFilteredTail } : std::string_view{ FilteredScanlines }.substr(Arithmetic::Max(BlockStartpoint - WindowSize, 0_z), Arithmetic::Min(BlockStartpoint, WindowSize));
+				CompressedBlocks[Index] = CompressBlock(Data, Dictionary);
+				BlockChecksums[Index] = adler32(adler32(0, nullptr, 0), reinterpret_cast<const Bytef*>(Data.data()), static_cast<uInt>(Data.size()));
+			});
+			if (std::find(CompressedBlocks.begin(), CompressedBlocks.end(), std::nullopt) != CompressedBlocks.end())
+				throw std::runtime_error{ "Failed to deflate PNG image data!" };
+			for (auto Index : Range{ std::ssize(Blocks) }) {
+				WriteChunk("IDAT", *CompressedBlocks[Index]);
+				Checksum = adler32_combine(Checksum, BlockChecksums[Index], static_cast<z_off_t>((Blocks[Index][1] - Blocks[Index][0]) * FilteredScanlineSize));
+			}
+			if (Height > 0) {
+				PreviousScanline.assign(Scanlines, (Height - 1) * ScanlineSize);
+				PreviousFilteredTail = (PreviousFilteredTail + FilteredScanlines).substr(Arithmetic::Max(std::ssize(PreviousFilteredTail) + std::ssize(FilteredScanlines) - WindowSize, 0_z));
+			}
+		}
+		auto Finish() {
+			WriteChunk("IDAT", std::string{ '\x03', '\0' } + EncodeBigEndian(static_cast<std::uint32_t>(Checksum)));
+			WriteChunk("IEND", {});
+			OutputFile.flush();
+			return OutputFile.good();
+		}
+	};
+}
\ No newline at end of file
@@ -4,6 +4,7 @@
 #include <vector>
 #include <tuple>
 #include <array>
+#include <span>
 #include <list>
 #include <unordered_map>
 #include <type_traits>
@@ -16,6 +17,9 @@
 #include <limits>
 #include <utility>
 #include <memory>
+#include <mutex>
+#include <future>
+#include <filesystem>
 #include <initializer_list>
 #include <new>
 #include <stdexcept>
@@ -255,6 +259,10 @@ namespace Reflection::Private {
 	struct ContainerReplaceTypeArgument<ContainerTypeConstructor<TypeBeingReplaced, AllocatorTypeConstructor<TypeBeingReplaced>>, TargetElementType> {
 		using ReassembledType = ContainerTypeConstructor<TargetElementType, AllocatorTypeConstructor<TargetElementType>>;
 	};
+	template<typename TypeBeingReplaced, auto Length, typename TargetElementType>
+	struct ContainerReplaceTypeArgument<std::span<TypeBeingReplaced, Length>, TargetElementType> {
+		using ReassembledType = std::vector<TargetElementType>;
+	};
 
 	template<typename UnknownType>
 	struct ExtractInnermostTypeArgument {
@@ -421,4 +429,36 @@ auto operator|(auto&& SourceContainer, auto&& TransformationForEachElement) requ
 		return *static_cast<Reflection::ContainerReplaceElementType<decltype(SourceContainer), decltype(ApplyToEachElement(std::get<x>(SourceContainer)))...>*>(nullptr);
 	}(std::make_index_sequence<std::tuple_size_v<std::remove_cvref_t<decltype(SourceContainer)>>>{}))>;
 	return std::apply([&](auto&& ...x) { return ContainerType{ ApplyToEachElement(Forward(x))... }; }, Forward(SourceContainer));
-}
\ No newline at end of file
+}
+
+// a process wide table of immutable resources keyed by canonical path, so each file is loaded once however many
+// users ask for it. loading runs outside the lock, and concurrent requests for the same file wait on the first one.
+template<typename ResourceType>
+struct SharedCache {
+	field(Entries, std::unordered_map<std::string, std::shared_future<ResourceType>>{});
+	field(Lock, std::mutex{});
+
+public:
+	auto operator()(const std::string& Path, auto&& Loader) {
+		auto Key = [&] {
+			auto ErrorCode = std::error_code{};
+			auto CanonicalPath = std::filesystem::weakly_canonical(Path, ErrorCode);
+			return ErrorCode ? Path : CanonicalPath.string();
+		}();
+		auto Promise = std::promise<ResourceType>{};
+		auto [Entry, isLoader] = [&] {
+			auto Guard = std::scoped_lock{ Lock };
+			if (auto Entry = Entries.find(Key); Entry != Entries.end())
+				return std::tuple{ Entry->second, false };
+			return std::tuple{ Entries[Key] = Promise.get_future().share(), true };
+		}();
+		if (isLoader)
+			try {
+				Promise.set_value(Loader(Path));
+			}
+			catch (...) {
+				Promise.set_exception(std::current_exception());
+			}
+		return Entry.get();
+	}
+};
\ No newline at end of file
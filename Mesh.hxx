@@ -0,0 +1,605 @@
+#pragma once
+#include "Ray.hxx"
+#include "BVHNode.hxx"
+#include <fstream>
+#include <charconv>
+#include <thread>
+#include <variant>
+#include <cstring>
+
+namespace Meshes {
+	// vertex coordinates live in separate arrays and triangles in a flat index buffer, three indices each.
+	struct TriangleMesh {
+		field(x, std::vector<float>{});
+		field(y, std::vector<float>{});
+		field(z, std::vector<float>{});
+		field(Indices, std::vector<std::uint32_t>{});
+
+	public:
+		auto VertexCount() const {
+			return static_cast<std::ptrdiff_t>(x.size());
+		}
+		auto TriangleCount() const {
+			return static_cast<std::ptrdiff_t>(Indices.size() / 3);
+		}
+		auto Vertex(std::integral auto Index) const {
+			return glm::vec3{ x[Index], y[Index], z[Index] };
+		}
+		auto Triangle(std::integral auto Index) const {
+			return std::array{ Vertex(Indices[3 * Index]), Vertex(Indices[3 * Index + 1]), Vertex(Indices[3 * Index + 2]) };
+		}
+	};
+}
+
+namespace Meshes::OBJ {
+	auto SkipBlanks(const char* Cursor, const char* Endpoint) {
+		while (Cursor != Endpoint && (*Cursor == ' ' || *Cursor == '\t' || *Cursor == '\r'))
+			++Cursor;
+		return Cursor;
+	}
+	auto SkipToken(const char* Cursor, const char* Endpoint) {
+		while (Cursor != Endpoint && *Cursor != ' ' && *Cursor != '\t' && *Cursor != '\r' && *Cursor != '\n')
+			++Cursor;
+		return Cursor;
+	}
+	auto NextLine(const char* Cursor, const char* Endpoint) {
+		auto LineEndpoint = std::find(Cursor, Endpoint, '\n');
+		return LineEndpoint == Endpoint ? Endpoint : LineEndpoint + 1;
+	}
+	auto IsStatement(const char* Cursor, const char* Endpoint, char Keyword) {
+		return Endpoint - Cursor > 1 && Cursor[0] == Keyword && (Cursor[1] == ' ' || Cursor[1] == '\t');
+	}
+
+	// chunks end on line boundaries, at least a megabyte each so small files are parsed in one go.
+	auto SplitIntoChunks(std::string_view Text) {
+		auto ChunkCount = Arithmetic::Max(Arithmetic::Min(static_cast<std::ptrdiff_t>(Text.size() >> 20), 4 * static_cast<std::ptrdiff_t>(std::thread::hardware_concurrency())), 1_z);
+		auto [Startpoint, Endpoint] = std::tuple{ Text.data(), Text.data() + Text.size() };
+		auto Boundaries = std::vector{ Startpoint };
+		for (auto x : Range{ 1, ChunkCount })
+			if (auto Boundary = NextLine(Arithmetic::Max(Startpoint + Text.size() * x / ChunkCount, Boundaries.back()), Endpoint); Boundary != Endpoint)
+				Boundaries.push_back(Boundary);
+		Boundaries.push_back(Endpoint);
+		return Boundaries;
+	}
+
+	// two passes over the chunks in parallel: the first counts vertices so every chunk knows where its vertices go
+	// (and how to resolve relative indices), the second parses vertices straight into place and triangulates faces.
+	auto Parse(std::string_view Text, std::string_view Path) {
+		auto Boundaries = SplitIntoChunks(Text);
+		auto Chunks = std::vector<std::ptrdiff_t>(Boundaries.size() - 1);
+		std::iota(Chunks.begin(), Chunks.end(), 0_z);
+		auto [VertexCounts, LineCounts] = std::tuple{ std::vector<std::ptrdiff_t>(Boundaries.size() - 1), std::vector<std::ptrdiff_t>(Boundaries.size() - 1) };
+		std::for_each(std::execution::par, Chunks.begin(), Chunks.end(), [&](auto Chunk) {
+			for (auto Cursor = Boundaries[Chunk]; Cursor != Boundaries[Chunk + 1]; Cursor = NextLine(Cursor, Boundaries[Chunk + 1]), ++LineCounts[Chunk])
+				VertexCounts[Chunk] += IsStatement(SkipBlanks(Cursor, Boundaries[Chunk + 1]), Boundaries[Chunk + 1], 'v');
+		});
+		auto [VertexOffsets, LineOffsets] = std::tuple{ std::vector<std::ptrdiff_t>(VertexCounts.size()), std::vector<std::ptrdiff_t>(LineCounts.size()) };
+		std::exclusive_scan(VertexCounts.begin(), VertexCounts.end(), VertexOffsets.begin(), 0_z);
+		std::exclusive_scan(LineCounts.begin(), LineCounts.end(), LineOffsets.begin(), 1_z);
+
+		auto Mesh = TriangleMesh{};
+		auto VertexCount = VertexOffsets.back() + VertexCounts.back();
+		Mesh.x.resize(VertexCount);
+		Mesh.y.resize(VertexCount);
+		Mesh.z.resize(VertexCount);
+		auto ChunkIndices = std::vector<std::vector<std::uint32_t>>(VertexCounts.size());
+		auto ChunkErrors = std::vector<std::string>(VertexCounts.size());
+		std::for_each(std::execution::par, Chunks.begin(), Chunks.end(), [&](auto Chunk) {
+			auto [Endpoint, VertexIndex, Line] = std::tuple{ Boundaries[Chunk + 1], VertexOffsets[Chunk], 0_z };
+			auto Polygon = std::vector<std::ptrdiff_t>{};
+			auto ReportError = [&](auto&& Message) {
+				ChunkErrors[Chunk] = Message + " in "s + std::string{ Path } + " (line " + std::to_string(LineOffsets[Chunk] + Line) + ")";
+			};
+			for (auto Cursor = Boundaries[Chunk]; Cursor != Endpoint && ChunkErrors[Chunk].empty(); Cursor = NextLine(Cursor, Endpoint), ++Line)
+				if (auto Statement = SkipBlanks(Cursor, Endpoint); IsStatement(Statement, Endpoint, 'v')) {
+					auto Coordinates = std::array{ &Mesh.x[VertexIndex], &Mesh.y[VertexIndex], &Mesh.z[VertexIndex] };
+					for (auto Token = Statement + 1; auto Coordinate : Coordinates)
+						if (auto [TokenEndpoint, ErrorCode] = std::from_chars(Token = SkipBlanks(Token, Endpoint), Endpoint, *Coordinate); ErrorCode == std::errc{})
+							Token = TokenEndpoint;
+						else
+							ReportError("Malformed vertex"s);
+					++VertexIndex;
+				}
+				else if (IsStatement(Statement, Endpoint, 'f')) {
+					Polygon.clear();
+					for (auto Token = SkipBlanks(Statement + 1, Endpoint); Token != Endpoint && *Token != '\n'; Token = SkipBlanks(SkipToken(Token, Endpoint), Endpoint))
+						if (auto Index = 0_z; std::from_chars(Token, Endpoint, Index).ec == std::errc{} && Index != 0)
+							Polygon.push_back(Index > 0 ? Index - 1 : VertexIndex + Index);
+						else
+							ReportError("Malformed face"s);
+					if (Polygon.size() < 3)
+						ReportError("Degenerate face"s);
+					for (auto x : Range{ 2, static_cast<std::ptrdiff_t>(Polygon.size()) })
+						for (auto Index : { Polygon[0], Polygon[x - 1], Polygon[x] })
+							if (Index >= 0 && Index < VertexCount)
+								ChunkIndices[Chunk].push_back(static_cast<std::uint32_t>(Index));
+							else
+								ReportError("Vertex index out of range"s);
+				}
+		});
+		for (auto&& Error : ChunkErrors)
+			if (Error.empty() == false)
+				throw std::runtime_error{ Error };
+		for (auto&& Indices : ChunkIndices)
+			Mesh.Indices += Indices;
+		return Mesh;
+	}
+	auto Load(const std::string& Path) {
+		auto File = std::ifstream{ Path, std::ios::binary | std::ios::ate };
+		if (File.is_open() == false)
+			throw std::runtime_error{ "Failed to open mesh file " + Path + "!" };
+		auto Text = std::string(static_cast<std::size_t>(File.tellg()), '\0');
+		File.seekg(0).read(Text.data(), Text.size());
+		return Parse(Text, Path);
+	}
+}
+
+namespace Meshes {
+	struct BoundingBox {
+		field(Lower, glm::vec3{ std::numeric_limits<float>::infinity() });
+		field(Upper, glm::vec3{ -std::numeric_limits<float>::infinity() });
+
+	public:
+		auto& operator+=(const glm::vec3& Point) {
+			Lower = glm::min(Lower, Point);
+			Upper = glm::max(Upper, Point);
+			return *this;
+		}
+		auto& operator+=(const BoundingBox& OtherBox) {
+			Lower = glm::min(Lower, OtherBox.Lower);
+			Upper = glm::max(Upper, OtherBox.Upper);
+			return *this;
+		}
+		auto SurfaceArea() const {
+			auto Extent = glm::max(Upper - Lower, glm::vec3{ 0 });
+			return 2 * (Extent.x * Extent.y + Extent.y * Extent.z + Extent.z * Extent.x);
+		}
+	};
+
+#if defined(__AVX__)
+	constexpr auto TriangleBlockWidth = 8_z;
+#else
+	constexpr auto TriangleBlockWidth = 4_z;
+#endif
+
+	// binned SAH build; the mesh's triangles are reordered so every leaf covers a contiguous run of them.
+	// leaves are priced by the number of triangle blocks they occupy, since a partially filled block costs a full pass.
+	struct BoundingVolumeHierarchy {
+		static constexpr auto BinCount = 12_z;
+		static constexpr auto MaximumLeafSize = 2 * TriangleBlockWidth;
+		static constexpr auto MaximumDepth = 56_z;
+		static constexpr auto TraversalCost = 1.f;
+		field(Nodes, std::vector<BVHNode>{});
+
+	private:
+		struct TriangleRecord {
+			field(Bounds, BoundingBox{});
+			field(Centroid, glm::vec3{});
+			field(Index, 0_u32);
+		};
+		static auto BlockCount(std::ptrdiff_t TriangleCount) {
+			return static_cast<float>((TriangleCount + TriangleBlockWidth - 1) / TriangleBlockWidth);
+		}
+		auto Subdivide(std::span<TriangleRecord> Triangles, std::uint32_t Offset, std::ptrdiff_t Depth)->void {
+			auto [Bounds, CentroidBounds] = std::tuple{ BoundingBox{}, BoundingBox{} };
+			for (auto&& x : Triangles) {
+				Bounds += x.Bounds;
+				CentroidBounds += x.Centroid;
+			}
+			auto NodeIndex = Nodes.size();
+			Nodes.push_back({ .Lower = Bounds.Lower, .Offset = Offset, .Upper = Bounds.Upper, .Count = static_cast<std::uint32_t>(Triangles.size()) });
+			auto Count = static_cast<std::ptrdiff_t>(Triangles.size());
+			auto Axis = [&] {
+				auto Extent = CentroidBounds.Upper - CentroidBounds.Lower;
+				return Extent.x >= Extent.y && Extent.x >= Extent.z ? 0 : Extent.y >= Extent.z ? 1 : 2;
+			}();
+			auto [AxisStartpoint, AxisExtent] = std::tuple{ CentroidBounds.Lower[Axis], CentroidBounds.Upper[Axis] - CentroidBounds.Lower[Axis] };
+			if (Count <= 2 || Depth >= MaximumDepth || (AxisExtent <= 0 && Count <= MaximumLeafSize))
+				return;
+
+			auto BinOf = [&](auto&& x) {
+				return Arithmetic::Min(static_cast<std::ptrdiff_t>(BinCount * (x.Centroid[Axis] - AxisStartpoint) / AxisExtent), BinCount - 1);
+			};
+			auto Middle = Triangles.begin() + Count / 2;
+			if (AxisExtent > 0) {
+				auto [BinBounds, BinSizes] = std::tuple{ std::array<BoundingBox, BinCount>{}, std::array<std::ptrdiff_t, BinCount>{} };
+				for (auto&& x : Triangles) {
+					BinBounds[BinOf(x)] += x.Bounds;
+					++BinSizes[BinOf(x)];
+				}
+				auto RightCosts = std::array<float, BinCount>{};
+				for (auto [AccumulatedBounds, AccumulatedSize, Bin] = std::tuple{ BoundingBox{}, 0_z, BinCount - 1 }; Bin > 0; --Bin) {
+					AccumulatedBounds += BinBounds[Bin];
+					AccumulatedSize += BinSizes[Bin];
+					RightCosts[Bin] = AccumulatedBounds.SurfaceArea() * BlockCount(AccumulatedSize);
+				}
+				auto [BestCost, BestSplit] = std::tuple{ std::numeric_limits<float>::infinity(), 0_z };
+				for (auto [AccumulatedBounds, AccumulatedSize, Bin] = std::tuple{ BoundingBox{}, 0_z, 1_z }; Bin < BinCount; ++Bin) {
+					AccumulatedBounds += BinBounds[Bin - 1];
+					AccumulatedSize += BinSizes[Bin - 1];
+					if (auto Cost = AccumulatedBounds.SurfaceArea() * BlockCount(AccumulatedSize) + RightCosts[Bin]; Cost < BestCost)
+						std::tie(BestCost, BestSplit) = std::tuple{ Cost, Bin };
+				}
+				if (Count <= MaximumLeafSize && TraversalCost * Bounds.SurfaceArea() + BestCost >= Bounds.SurfaceArea() * BlockCount(Count))
+					return;
+				Middle = std::partition(Triangles.begin(), Triangles.end(), [&](auto&& x) { return BinOf(x) < BestSplit; });
+			}
+			if (Middle == Triangles.begin() || Middle == Triangles.end()) {
+				Middle = Triangles.begin() + Count / 2;
+				std::nth_element(Triangles.begin(), Middle, Triangles.end(), [&](auto&& x, auto&& y) { return x.Centroid[Axis] < y.Centroid[Axis]; });
+			}
+
+			auto LeftCount = static_cast<std::uint32_t>(Middle - Triangles.begin());
+			Nodes[NodeIndex].Count = 0;
+			Subdivide(Triangles.first(LeftCount), Offset, Depth + 1);
+			Nodes[NodeIndex].Offset = static_cast<std::uint32_t>(Nodes.size());
+			Subdivide(Triangles.subspan(LeftCount), Offset + LeftCount, Depth + 1);
+		}
+
+	public:
+		BoundingVolumeHierarchy() = default;
+		BoundingVolumeHierarchy(TriangleMesh& Mesh) {
+			auto Triangles = std::vector<TriangleRecord>(Mesh.TriangleCount());
+			for (auto x : Range{ Mesh.TriangleCount() }) {
+				Triangles[x].Index = static_cast<std::uint32_t>(x);
+				for (auto&& Vertex : Mesh.Triangle(x))
+					Triangles[x].Bounds += Vertex;
+				Triangles[x].Centroid = (Triangles[x].Bounds.Lower + Triangles[x].Bounds.Upper) / 2.f;
+			}
+			if (Triangles.empty())
+				return;
+			Subdivide(Triangles, 0, 0);
+			auto ReorderedIndices = std::vector<std::uint32_t>{};
+			ReorderedIndices.reserve(Mesh.Indices.size());
+			for (auto&& x : Triangles)
+				ReorderedIndices.insert(ReorderedIndices.end(), Mesh.Indices.begin() + 3 * x.Index, Mesh.Indices.begin() + 3 * x.Index + 3);
+			Mesh.Indices = std::move(ReorderedIndices);
+		}
+	};
+
+	// up to TriangleBlockWidth triangles with their vertices gathered lane by lane, so one pass of the intersection
+	// kernel tests all of them. unused lanes hold NaN vertices, which never report a hit.
+	struct TriangleBlock {
+		alignas(4 * TriangleBlockWidth) field(Vertices, std::array<std::array<std::array<float, TriangleBlockWidth>, 3>, 3>{}); // [vertex][axis][lane]
+
+	public:
+		static auto Empty() {
+			auto Block = TriangleBlock{};
+			for (auto& Vertex : Block.Vertices)
+				for (auto& Lanes : Vertex)
+					Lanes.fill(std::numeric_limits<float>::quiet_NaN());
+			return Block;
+		}
+	};
+
+	// the hierarchy over blocks of triangles, copied out of the index buffer leaf by leaf; the buffers themselves are dropped.
+	struct AcceleratedMesh {
+		field(Hierarchy, BoundingVolumeHierarchy{});
+		field(Blocks, std::vector<TriangleBlock>{});
+		field(TriangleCount, 0_z);
+
+	public:
+		AcceleratedMesh() = default;
+		AcceleratedMesh(TriangleMesh Geometry) : Hierarchy{ Geometry }, TriangleCount{ Geometry.TriangleCount() } {
+			auto EmptyBlock = TriangleBlock::Empty();
+			for (auto& Node : Hierarchy.Nodes)
+				if (Node.Count > 0) {
+					auto FirstTriangle = Node.Offset;
+					Node.Offset = static_cast<std::uint32_t>(Blocks.size());
+					for (auto x : Range{ Node.Count }) {
+						if (x % TriangleBlockWidth == 0)
+							Blocks.push_back(EmptyBlock);
+						for (auto Triangle = Geometry.Triangle(FirstTriangle + x); auto Vertex : Range{ 3 })
+							for (auto Axis : Range{ 3 })
+								Blocks.back().Vertices[Vertex][Axis][x % TriangleBlockWidth] = Triangle[Vertex][Axis];
+					}
+				}
+		}
+	};
+
+	// the out of core form of a mesh: the hierarchy as is, with every leaf encoded into a run of 32-bit words that is
+	// only decoded (a block at a time) when a ray reaches the leaf, so a mapped mesh pages in just the geometry rays touch.
+	// vertices are snapped to a lattice over the whole mesh, coarse enough that every leaf fits 16-bit offsets from its
+	// lower corner; the lattice being shared, a vertex decodes identically in every leaf and no cracks open between them.
+	// a leaf is its lower corner on the lattice (3 words) and its vertex count (1 word), followed by the offsets of its
+	// vertices and three indices per triangle into them, a byte each unless there are more than 256 vertices; both arrays
+	// are padded to whole words.
+	struct QuantizedMesh {
+		static constexpr auto LatticeResolution = 1 << 23; // lattice coordinates stay exact as floats
+		static constexpr auto OffsetLimit = 65535;
+		field(Nodes, std::span<const BVHNode>{});
+		field(Leaves, std::span<const std::uint32_t>{});
+		field(LatticeOrigin, glm::vec3{});
+		field(LatticeStep, glm::vec3{ 1 });
+		field(TriangleCount, 0_z);
+		field(Storage, std::shared_ptr<const void>{}); // keeps what the spans point into alive: a file mapping, or the buffers encoded below
+
+	public:
+		auto LatticePoint(std::uint32_t Coordinate, std::ptrdiff_t Axis) const {
+			return LatticeOrigin[Axis] + static_cast<float>(Coordinate) * LatticeStep[Axis];
+		}
+
+		QuantizedMesh() = default;
+		QuantizedMesh(const AcceleratedMesh& Mesh) : TriangleCount{ Mesh.TriangleCount } {
+			auto Buffers = std::make_shared<std::tuple<std::vector<BVHNode>, std::vector<std::uint32_t>>>(Mesh.Hierarchy.Nodes, std::vector<std::uint32_t>{});
+			auto& [EncodedNodes, EncodedLeaves] = *Buffers;
+			Storage = Buffers;
+			if (EncodedNodes.empty())
+				return;
+
+			auto LeafExtent = glm::vec3{ 0 };
+			for (auto&& Node : EncodedNodes)
+				if (Node.Count > 0)
+					LeafExtent = glm::max(LeafExtent, Node.Upper - Node.Lower);
+			LatticeOrigin = EncodedNodes[0].Lower;
+			for (auto Axis : Range{ 3 })
+				if (auto Step = Arithmetic::Max((EncodedNodes[0].Upper[Axis] - LatticeOrigin[Axis]) / LatticeResolution, LeafExtent[Axis] / (OffsetLimit - 1)); Step > 0)
+					LatticeStep[Axis] = Step;
+			auto Snap = [&](auto&& Block, auto Vertex, auto Lane) {
+				auto Coordinates = std::array<std::uint32_t, 3>{};
+				for (auto Axis : Range{ 3 })
+					Coordinates[Axis] = static_cast<std::uint32_t>(Arithmetic::Max(std::lround((static_cast<double>(Block.Vertices[Vertex][Axis][Lane]) - LatticeOrigin[Axis]) / LatticeStep[Axis]), 0l));
+				return Coordinates;
+			};
+			auto Append = [&](auto&& Elements) {
+				auto Bytes = std::as_bytes(std::span{ Elements });
+				auto Offset = EncodedLeaves.size();
+				EncodedLeaves.resize(Offset + (Bytes.size() + 3) / 4);
+				std::memcpy(EncodedLeaves.data() + Offset, Bytes.data(), Bytes.size());
+			};
+
+			for (auto& Node : EncodedNodes)
+				if (Node.Count > 0) {
+					auto Corners = std::vector<std::array<std::uint32_t, 3>>{};
+					for (auto x : Range{ static_cast<std::ptrdiff_t>(Node.Count) })
+						for (auto Vertex : Range{ 3 })
+							Corners.push_back(Snap(Mesh.Blocks[Node.Offset + x / TriangleBlockWidth], Vertex, x % TriangleBlockWidth));
+					auto Vertices = Corners;
+					std::sort(Vertices.begin(), Vertices.end());
+					Vertices.erase(std::unique(Vertices.begin(), Vertices.end()), Vertices.end());
+					auto LowerCorner = Vertices[0];
+					for (auto&& Vertex : Vertices)
+						for (auto Axis : Range{ 3 })
+							LowerCorner[Axis] = Arithmetic::Min(LowerCorner[Axis], Vertex[Axis]);
+
+					if (EncodedLeaves.size() > std::numeric_limits<std::uint32_t>::max() || Vertices.size() > 65536)
+						throw std::runtime_error{ "Mesh is too large to be quantized!" };
+					Node.Offset = static_cast<std::uint32_t>(EncodedLeaves.size());
+					Append(std::array{ LowerCorner[0], LowerCorner[1], LowerCorner[2], static_cast<std::uint32_t>(Vertices.size()) });
+					auto Offsets = std::vector<std::uint16_t>{};
+					auto Bounds = BoundingBox{};
+					for (auto&& Vertex : Vertices)
+						for (auto Axis : Range{ 3 })
+							if (auto Offset = Vertex[Axis] - LowerCorner[Axis]; Offset <= OffsetLimit)
+								Offsets.push_back(static_cast<std::uint16_t>(Offset));
+							else
+								throw std::runtime_error{ "Leaf exceeds the quantization lattice!" };
+					for (auto&& Vertex : Vertices)
+						Bounds += glm::vec3{ LatticePoint(Vertex[0], 0), LatticePoint(Vertex[1], 1), LatticePoint(Vertex[2], 2) };
+					Append(Offsets);
+					auto IndexOf = [&](auto&& Corner) { return std::lower_bound(Vertices.begin(), Vertices.end(), Corner) - Vertices.begin(); };
+					if (Vertices.size() > 256)
+						Append(Corners | [&](auto&& Corner) { return static_cast<std::uint16_t>(IndexOf(Corner)); });
+					else
+						Append(Corners | [&](auto&& Corner) { return static_cast<std::uint8_t>(IndexOf(Corner)); });
+					std::tie(Node.Lower, Node.Upper) = std::tuple{ Bounds.Lower, Bounds.Upper };
+				}
+
+			// snapping moves vertices by up to half a step, so the interior bounds are refitted to the leaves, children first
+			for (auto NodeIndex = EncodedNodes.size(); NodeIndex-- > 0;)
+				if (auto& Node = EncodedNodes[NodeIndex]; Node.Count == 0) {
+					auto [NearChild, FarChild] = std::tuple{ EncodedNodes[NodeIndex + 1], EncodedNodes[Node.Offset] };
+					std::tie(Node.Lower, Node.Upper) = std::tuple{ glm::min(NearChild.Lower, FarChild.Lower), glm::max(NearChild.Upper, FarChild.Upper) };
+				}
+			Nodes = EncodedNodes;
+			Leaves = EncodedLeaves;
+		}
+	};
+
+	// a mesh either lives in memory as parsed from an OBJ file, or is mapped from a compiled mesh file.
+	using Geometry = std::variant<std::shared_ptr<const AcceleratedMesh>, std::shared_ptr<const QuantizedMesh>>;
+
+	auto Load(const std::string& Path) {
+		return std::make_shared<const AcceleratedMesh>(OBJ::Load(Path));
+	}
+
+	// instances of a meshfile share its hierarchy and differ only in the ctm they are placed with.
+	inline auto Cache = SharedCache<Geometry>{};
+}
+
+namespace Meshes {
+	// the ray dependent half of the watertight test (Woop et al.): axes are permuted so z is the dominant direction,
+	// and a shear maps the ray onto the z axis. triangles are then tested in 2D against the origin, with edge
+	// functions that agree exactly on shared edges, so rays cannot slip between neighboring triangles.
+	struct WatertightRay {
+		field(Origin, glm::vec3{});
+		field(InverseDirection, glm::vec3{});
+		field(Axes, std::array{ 0_z, 1_z, 2_z });
+		field(Shear, glm::vec3{});
+
+	public:
+		WatertightRay(const glm::vec3& EyePoint, const glm::vec3& RayDirection) {
+			auto Magnitude = glm::abs(RayDirection);
+			auto z = Magnitude.x >= Magnitude.y && Magnitude.x >= Magnitude.z ? 0_z : Magnitude.y >= Magnitude.z ? 1_z : 2_z;
+			auto [x, y] = std::tuple{ (z + 1) % 3, (z + 2) % 3 };
+			if (RayDirection[z] < 0)
+				std::swap(x, y);
+			Origin = EyePoint;
+			InverseDirection = 1.f / RayDirection;
+			Axes = { x, y, z };
+			Shear = { RayDirection[x] / RayDirection[z], RayDirection[y] / RayDirection[z], 1 / RayDirection[z] };
+		}
+	};
+
+	auto IntersectBox(auto&& Node, auto&& RayQuery, auto DistanceLimit) {
+		auto [NearDistances, FarDistances] = std::tuple{ (Node.Lower - RayQuery.Origin) * RayQuery.InverseDirection, (Node.Upper - RayQuery.Origin) * RayQuery.InverseDirection };
+		auto [Entry, Exit] = std::tuple{ glm::min(NearDistances, FarDistances), glm::max(NearDistances, FarDistances) };
+		auto [EntryDistance, ExitDistance] = std::tuple{ std::max({ Entry.x, Entry.y, Entry.z, 0.f }), std::min({ Exit.x, Exit.y, Exit.z, DistanceLimit }) };
+		return EntryDistance <= ExitDistance ? EntryDistance : std::numeric_limits<float>::infinity();
+	}
+
+	// distances to every triangle of a block, infinity where a lane misses or lies beyond DistanceLimit.
+	// the lane loop is branch free so it compiles to a single SSE/AVX sweep; lanes whose edge functions come out
+	// exactly zero are redone in double precision afterwards, as the watertight algorithm requires.
+	auto IntersectBlock(const TriangleBlock& Block, const WatertightRay& RayQuery, float DistanceLimit) {
+		auto [x, y, z] = RayQuery.Axes;
+		auto [Sx, Sy, Sz] = std::array{ RayQuery.Shear.x, RayQuery.Shear.y, RayQuery.Shear.z };
+		auto [Ox, Oy, Oz] = std::array{ RayQuery.Origin[x], RayQuery.Origin[y], RayQuery.Origin[z] };
+		auto& [A, B, C] = Block.Vertices;
+		auto ShearedVertices = [&](auto Lane) {
+			auto [Az, Bz, Cz] = std::array{ A[z][Lane] - Oz, B[z][Lane] - Oz, C[z][Lane] - Oz };
+			return std::array{
+				A[x][Lane] - Ox - Sx * Az, A[y][Lane] - Oy - Sy * Az, Az,
+				B[x][Lane] - Ox - Sx * Bz, B[y][Lane] - Oy - Sy * Bz, Bz,
+				C[x][Lane] - Ox - Sx * Cz, C[y][Lane] - Oy - Sy * Cz, Cz
+			};
+		};
+		// bitwise rather than logical operators and a final select keep the lane loop free of branches
+		auto Resolve = [&](auto U, auto V, auto W, auto Az, auto Bz, auto Cz) {
+			auto Determinant = U + V + W;
+			auto t = static_cast<float>(Sz * (U * Az + V * Bz + W * Cz) / Determinant);
+			auto Inside = ((U >= 0) & (V >= 0) & (W >= 0)) | ((U <= 0) & (V <= 0) & (W <= 0));
+			return Inside & (Determinant != 0) & (t >= 0) & (t < DistanceLimit) ? t : std::numeric_limits<float>::infinity();
+		};
+
+		auto [Distances, OnEdge] = std::tuple{ std::array<float, TriangleBlockWidth>{}, std::array<std::int32_t, TriangleBlockWidth>{} };
+		for (auto Lane = 0_z; Lane < TriangleBlockWidth; ++Lane) {
+			auto [Ax, Ay, Az, Bx, By, Bz, Cx, Cy, Cz] = ShearedVertices(Lane);
+			auto [U, V, W] = std::array{ Cx * By - Cy * Bx, Ax * Cy - Ay * Cx, Bx * Ay - By * Ax };
+			Distances[Lane] = Resolve(U, V, W, Az, Bz, Cz);
+			OnEdge[Lane] = (U == 0) | (V == 0) | (W == 0);
+		}
+		for (auto Lane = 0_z; Lane < TriangleBlockWidth; ++Lane)
+			if (OnEdge[Lane]) {
+				auto [Ax, Ay, Az, Bx, By, Bz, Cx, Cy, Cz] = ShearedVertices(Lane) | [](auto x) { return static_cast<double>(x); };
+				Distances[Lane] = Resolve(Cx * By - Cy * Bx, Ax * Cy - Ay * Cx, Bx * Ay - By * Ax, Az, Bz, Cz);
+			}
+		return Distances;
+	}
+
+	auto HierarchyOf(const AcceleratedMesh& Mesh) {
+		return std::span{ Mesh.Hierarchy.Nodes };
+	}
+	auto HierarchyOf(const QuantizedMesh& Mesh) {
+		return Mesh.Nodes;
+	}
+
+	// front to back traversal; DistanceLimit shrinks as VisitLeaf finds closer hits, and VisitLeaf returns true to stop early.
+	// a mapped hierarchy is never checked up front (that would page all of it in), so child links are checked as they are
+	// followed: children come after their parent, which also rules out cycles.
+	auto Traverse(auto&& Mesh, const WatertightRay& RayQuery, float& DistanceLimit, auto&& VisitLeaf) {
+		auto Nodes = HierarchyOf(Mesh);
+		auto PendingNodes = std::array<std::tuple<std::uint32_t, float>, BoundingVolumeHierarchy::MaximumDepth + 1>{};
+		auto PendingNodeCount = 0_z;
+		if (Nodes.empty() == false)
+			PendingNodes[PendingNodeCount++] = { 0, IntersectBox(Nodes[0], RayQuery, DistanceLimit) };
+		while (PendingNodeCount > 0)
+			if (auto [NodeIndex, EntryDistance] = PendingNodes[--PendingNodeCount]; EntryDistance <= DistanceLimit) {
+				if (auto& Node = Nodes[NodeIndex]; Node.Count > 0) {
+					if (VisitLeaf(Node))
+						return;
+				}
+				else if (auto [NearChild, FarChild] = std::array{ NodeIndex + 1, Node.Offset }; NearChild < FarChild && FarChild < Nodes.size() && PendingNodeCount + 2 <= std::ssize(PendingNodes)) {
+					auto [NearDistance, FarDistance] = std::array{ IntersectBox(Nodes[NearChild], RayQuery, DistanceLimit), IntersectBox(Nodes[FarChild], RayQuery, DistanceLimit) };
+					if (NearDistance > FarDistance) {
+						std::swap(NearChild, FarChild);
+						std::swap(NearDistance, FarDistance);
+					}
+					if (FarDistance != std::numeric_limits<float>::infinity())
+						PendingNodes[PendingNodeCount++] = { FarChild, FarDistance };
+					if (NearDistance != std::numeric_limits<float>::infinity())
+						PendingNodes[PendingNodeCount++] = { NearChild, NearDistance };
+				}
+			}
+	}
+
+	// hands the triangle blocks of a leaf to Visitor until it returns true.
+	auto VisitBlocks(const AcceleratedMesh& Mesh, const BVHNode& Node, auto&& Visitor) {
+		for (auto&& Block : std::span{ Mesh.Blocks }.subspan(Node.Offset, (Node.Count + TriangleBlockWidth - 1) / TriangleBlockWidth))
+			if (Visitor(Block))
+				return true;
+		return false;
+	}
+	// decodes the leaf a block at a time; a leaf running past the end of the file, or an index past its vertices, decodes
+	// to nothing (NaN vertices) rather than reading outside the mapping.
+	auto VisitBlocks(const QuantizedMesh& Mesh, const BVHNode& Node, auto&& Visitor) {
+		auto Leaf = Mesh.Leaves.subspan(Arithmetic::Min(std::size_t{ Node.Offset }, Mesh.Leaves.size()));
+		if (Leaf.size() < 4)
+			return false;
+		auto [LowerCorner, VertexCount, TriangleCount] = std::tuple{ std::array{ Leaf[0], Leaf[1], Leaf[2] }, Leaf[3], static_cast<std::ptrdiff_t>(Node.Count) };
+		auto IndexWidth = VertexCount > 256 ? 2_uz : 1_uz;
+		auto [VertexWords, IndexWords] = std::tuple{ (6 * std::uint64_t{ VertexCount } + 3) / 4, (3 * IndexWidth * TriangleCount + 3) / 4 };
+		if (VertexWords + IndexWords > Leaf.size() - 4)
+			return false;
+		auto VertexBytes = reinterpret_cast<const std::byte*>(Leaf.data() + 4);
+		auto IndexBytes = VertexBytes + 4 * VertexWords;
+		auto ReadIndex = [&](auto Corner) {
+			auto [Index8, Index16] = std::tuple{ std::uint8_t{}, std::uint16_t{} };
+			if (IndexWidth == 1)
+				std::memcpy(&Index8, IndexBytes + Corner, 1);
+			else
+				std::memcpy(&Index16, IndexBytes + 2 * Corner, 2);
+			return IndexWidth == 1 ? std::uint32_t{ Index8 } : std::uint32_t{ Index16 };
+		};
+		for (auto FirstTriangle = 0_z; FirstTriangle < TriangleCount; FirstTriangle += TriangleBlockWidth) {
+			auto Block = TriangleBlock::Empty();
+			for (auto Lane : Range{ Arithmetic::Min(TriangleBlockWidth, TriangleCount - FirstTriangle) })
+				for (auto Vertex : Range{ 3 })
+					if (auto Index = ReadIndex(3 * (FirstTriangle + Lane) + Vertex); Index < VertexCount) {
+						auto Offsets = std::array<std::uint16_t, 3>{};
+						std::memcpy(Offsets.data(), VertexBytes + 6 * Index, 6);
+						for (auto Axis : Range{ 3 })
+							Block.Vertices[Vertex][Axis][Lane] = Mesh.LatticePoint(LowerCorner[Axis] + Offsets[Axis], Axis);
+					}
+			if (Visitor(Block))
+				return true;
+		}
+		return false;
+	}
+
+	// closest hit in the mesh's object space, returned in the (t, normal) form of every other implicit function.
+	auto Intersect(auto&& Mesh, const glm::vec3& EyePoint, const glm::vec3& RayDirection) {
+		auto [NearestDistance, NearestNormal] = std::tuple{ std::numeric_limits<float>::infinity(), glm::vec3{} };
+		auto RayQuery = WatertightRay{ EyePoint, RayDirection };
+		Traverse(Mesh, RayQuery, NearestDistance, [&](auto&& Node) {
+			return VisitBlocks(Mesh, Node, [&](auto&& Block) {
+				for (auto Distances = IntersectBlock(Block, RayQuery, NearestDistance); auto Lane : Range{ TriangleBlockWidth })
+					if (Distances[Lane] < NearestDistance) {
+						auto [v0, v1, v2] = Block.Vertices | [&](auto&& Lanes) { return glm::vec3{ Lanes[0][Lane], Lanes[1][Lane], Lanes[2][Lane] }; };
+						std::tie(NearestDistance, NearestNormal) = std::tuple{ Distances[Lane], glm::cross(v1 - v0, v2 - v0) };
+					}
+				return false;
+			});
+		});
+		if (NearestDistance == std::numeric_limits<float>::infinity())
+			return std::tuple{ Ray::NoIntersection, glm::vec3{} };
+		return std::tuple{ static_cast<double>(NearestDistance), glm::normalize(NearestNormal) };
+	}
+
+	// any hit before DistanceLimit, for shadow rays.
+	auto DetectOcclusion(auto&& Mesh, const glm::vec3& EyePoint, const glm::vec3& RayDirection, double DistanceLimit) {
+		auto [Occluded, Limit, RayQuery] = std::tuple{ false, static_cast<float>(DistanceLimit), WatertightRay{ EyePoint, RayDirection } };
+		Traverse(Mesh, RayQuery, Limit, [&](auto&& Node) {
+			return VisitBlocks(Mesh, Node, [&](auto&& Block) {
+				for (auto Distance : IntersectBlock(Block, RayQuery, Limit))
+					if (Distance != std::numeric_limits<float>::infinity())
+						return Occluded = true;
+				return false;
+			});
+		});
+		return Occluded;
+	}
+}
+
+namespace ImplicitFunctions::Standard {
+	auto Mesh(auto Geometry) {
+		return [=](auto&& EyePoint, auto&& RayDirection) {
+			return Meshes::Intersect(*Geometry, EyePoint, RayDirection);
+		};
+	}
+	auto MeshOcclusion(auto Geometry) {
+		return [=](auto&& EyePoint, auto&& RayDirection, auto DistanceLimit) {
+			return Meshes::DetectOcclusion(*Geometry, EyePoint, RayDirection, DistanceLimit);
+		};
+	}
+}
\ No newline at end of file
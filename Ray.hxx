@@ -1,21 +1,23 @@
 ﻿#pragma once
 #include "glm_fix.hxx"
+#include "Sampling.hxx"
 
 namespace ViewPlane {
+	auto TransformationFromCameraSpaceToWorldSpace(auto&& Camera) {
+		auto w = -Camera.Look;
+		auto v = glm::normalize(Camera.Up - glm::dot(Camera.Up, w) * w);
+		auto u = glm::cross(v, w);
+		return glm::translate(Camera.Position) * glm::mat4{
+			u.x, u.y, u.z, 0.f,
+			v.x, v.y, v.z, 0.f,
+			w.x, w.y, w.z, 0.f,
+			0.f, 0.f, 0.f, 1.f
+		};
+	}
 	auto ConfigureProjectorFromScreenSpaceToWorldSpace(auto&& Camera, auto Width, auto Height) {
 		auto V = 2 * Camera.FocalLength * std::tan(Camera.HeightAngle / 2);
 		auto U = V * Width / Height;
-		auto TransformationToWorldSpace = [&] {
-			auto w = -Camera.Look;
-			auto v = glm::normalize(Camera.Up - glm::dot(Camera.Up, w) * w);
-			auto u = glm::cross(v, w);
-			return glm::translate(Camera.Position) * glm::mat4{
-				u.x, u.y, u.z, 0.f,
-				v.x, v.y, v.z, 0.f,
-				w.x, w.y, w.z, 0.f,
-				0.f, 0.f, 0.f, 1.f
-			};
-		}();
+		auto TransformationToWorldSpace = TransformationFromCameraSpaceToWorldSpace(Camera);
 		return [=](auto x, auto y) {
 			auto NormalizedX = (x + 0.5) / Width - 0.5;
 			auto NormalizedY = 0.5 - (y + 0.5) / Height;
@@ -23,6 +25,14 @@ namespace ViewPlane {
 			return glm::vec3{ HomogenizedCoordinates };
 		};
 	}
+	auto ConfigureProjectorFromApertureToWorldSpace(auto&& Camera) {
+		auto TransformationToWorldSpace = TransformationFromCameraSpaceToWorldSpace(Camera);
+		return [=](auto u, auto v) {
+			auto [x, y] = Sampling::Warps::ConcentricDisk(u, v);
+			auto HomogenizedCoordinates = TransformationToWorldSpace * glm::vec4{ Camera.Aperture / 2 * x, Camera.Aperture / 2 * y, 0., 1. };
+			return glm::vec3{ HomogenizedCoordinates };
+		};
+	}
 }
 
 namespace Ray {
@@ -45,16 +55,19 @@ namespace Ray {
 			auto& [ImplicitFunction, Material] = x;
 			return ImplicitFunction(EyePoint, RayDirection) + std::tuple<decltype(Material)&>{ Material };
 		};
-		return *std::min_element(IntersectionRecords.begin(), IntersectionRecords.end(), [](auto&& x, auto&& y) { return std::get<0>(x) < std::get<0>(y); });
+		auto NearestIntersection = std::min_element(IntersectionRecords.begin(), IntersectionRecords.end(), [](auto&& x, auto&& y) { return std::get<0>(x) < std::get<0>(y); });
+		auto ObjectIndex = std::get<0>(*NearestIntersection) != NoIntersection ? ContainerManipulators::Distance(IntersectionRecords.begin(), NearestIntersection) : -1_z;
+		return *NearestIntersection + std::tuple{ ObjectIndex };
 	}
 	auto DetectOcclusion(auto&& EyePoint, auto&& RayDirection, auto DistanceLimit, auto&& ObstructionRecords) {
-		for (auto&& ImplicitFunction : ObstructionRecords)
-			if (auto&& [t, _] = ImplicitFunction(EyePoint + SelfIntersectionDisplacement * RayDirection, RayDirection); t < DistanceLimit)
+		for (auto&& Obstruction : ObstructionRecords)
+			if (Obstruction(EyePoint + SelfIntersectionDisplacement * RayDirection, RayDirection, DistanceLimit))
 				return true;
 		return false;
 	}
-	auto Trace(auto&& EyePoint, auto&& RayDirection, auto&& IlluminationModel, auto&& ObjectRecords, auto RecursionDepth)->glm::vec3 {
-		if (auto&& [t, SurfaceNormal, SurfaceMaterial] = Intersect(EyePoint, RayDirection, ObjectRecords); RecursionDepth < RecursiveTracingDepth && t != NoIntersection) {
+	auto Trace(auto&& EyePoint, auto&& RayDirection, auto&& IlluminationModel, auto&& ObjectRecords, auto RecursionDepth)->glm::vec3;
+	auto Shade(auto&& EyePoint, auto&& RayDirection, auto&& IntersectionRecord, auto&& IlluminationModel, auto&& ObjectRecords, auto RecursionDepth)->glm::vec3 {
+		if (auto&& [t, SurfaceNormal, SurfaceMaterial, _] = IntersectionRecord; RecursionDepth < RecursiveTracingDepth && t != NoIntersection) {
 			auto IntersectionPosition = EyePoint + t * RayDirection;
 			auto AccumulateReflectedIntensity = [&] {
 				auto ReflectedRayDirection = Reflect(RayDirection, SurfaceNormal);
@@ -92,6 +105,9 @@ namespace Ray {
 		}
 		return { 0, 0, 0 };
 	}
+	auto Trace(auto&& EyePoint, auto&& RayDirection, auto&& IlluminationModel, auto&& ObjectRecords, auto RecursionDepth)->glm::vec3 {
+		return Shade(EyePoint, RayDirection, Intersect(EyePoint, RayDirection, ObjectRecords), IlluminationModel, ObjectRecords, RecursionDepth);
+	}
 }
 
 namespace Lights {
@@ -139,9 +155,15 @@ namespace Illuminations {
 	auto WhittedModel(auto& LightRecords, auto& ObstructionRecords) {
 		return [&](auto&& Material, auto&& SurfacePosition, auto&& SurfaceNormal, auto&& EyePoint, auto&& ReflectedIntensity, auto&& RefractedIntensity) {
 			auto AccumulatedIntensity = Ka * Material.AmbientCoefficients;
+			auto DiffuseCoefficients = [&] {
+				if constexpr (requires { Material.DiffuseTexture; })
+					if (Material.DiffuseTexture)
+						return Material.DiffuseTexture(SurfacePosition, SurfaceNormal, glm::distance(EyePoint, SurfacePosition));
+				return Material.DiffuseCoefficients;
+			}();
 			for (auto&& Light : LightRecords)
 				if (auto [LightDistance, LightDirection, LightColor] = Light(SurfacePosition); Ray::DetectOcclusion(SurfacePosition, -LightDirection, LightDistance, ObstructionRecords) == false) {
-					AccumulatedIntensity += Diffuse(LightDirection, SurfaceNormal, LightColor, Kd * Material.DiffuseCoefficients);
+					AccumulatedIntensity += Diffuse(LightDirection, SurfaceNormal, LightColor, Kd * DiffuseCoefficients);
 					AccumulatedIntensity += Specular(LightDirection, SurfaceNormal, glm::normalize(EyePoint - SurfacePosition), LightColor, Ks * Material.SpecularCoefficients, Material.SpecularExponent);
 				}
 			return AccumulatedIntensity + Ks * Material.ReflectionCoefficients * ReflectedIntensity + Kt * Material.TransparencyCoefficients * RefractedIntensity;
@@ -152,8 +174,37 @@ namespace Illuminations {
 namespace ImplicitFunctions {
 	using Signature = auto(const glm::vec3&, const glm::vec3&)->std::tuple<double, glm::vec3>;
 	using Ǝ = std::function<Signature>;
+	using OcclusionSignature = auto(const glm::vec3&, const glm::vec3&, double)->bool;
+	using Obstruction = std::function<OcclusionSignature>;
 
 	constexpr auto ε = std::numeric_limits<double>::min();
+
+	// the any-hit form of an implicit function, answering whether anything lies closer than DistanceLimit.
+	// this one is built on the closest hit; shapes with a cheaper early-out test provide their own.
+	auto Occlusion(auto&& ImplicitFunction) {
+		return [=](auto&& EyePoint, auto&& RayDirection, auto DistanceLimit) {
+			auto [t, _] = ImplicitFunction(EyePoint, RayDirection);
+			return t < DistanceLimit;
+		};
+	}
+
+	auto Transform(auto&& InverseTransformation, auto&& NormalTransformation, auto&& ImplicitFunction) {
+		return [=](auto&& EyePoint, auto&& RayDirection) {
+			auto [ObjectSpaceEyePoint, ObjectSpaceRayDirection] = [&] {
+				auto [HomogenizedEyePoint, HomogenizedRayDirection] = std::tuple{ glm::vec4{ EyePoint, 1 }, glm::vec4{ RayDirection, 0 } };
+				return std::tuple{ glm::vec3{ InverseTransformation * HomogenizedEyePoint }, glm::vec3{ InverseTransformation * HomogenizedRayDirection } };
+			}();
+			if (auto [t, SurfaceNormal] = ImplicitFunction(ObjectSpaceEyePoint, ObjectSpaceRayDirection); t != Ray::NoIntersection)
+				return std::tuple{ t, glm::normalize(NormalTransformation * SurfaceNormal) };
+			return std::tuple{ Ray::NoIntersection, glm::vec3{} };
+		};
+	}
+	auto TransformOcclusion(auto&& InverseTransformation, auto&& Occlusion) {
+		return [=](auto&& EyePoint, auto&& RayDirection, auto DistanceLimit) {
+			auto [HomogenizedEyePoint, HomogenizedRayDirection] = std::tuple{ glm::vec4{ EyePoint, 1 }, glm::vec4{ RayDirection, 0 } };
+			return Occlusion(glm::vec3{ InverseTransformation * HomogenizedEyePoint }, glm::vec3{ InverseTransformation * HomogenizedRayDirection }, DistanceLimit);
+		};
+	}
 }
 
 namespace { // implicit function operators are globally visible
@@ -172,15 +223,7 @@ namespace { // implicit function operators are globally visible
 	auto operator*(SubtypeOf<glm::mat4> auto&& ObjectTransformation, auto&& ImplicitFunction) requires requires {
 		{ ImplicitFunction(glm::vec3{}, glm::vec3{}) }->SubtypeOf<std::tuple<double, glm::vec3>>;
 	} {
-		return [=, InverseTransformation = glm::inverse(ObjectTransformation), NormalTransformation = glm::inverse(glm::transpose(glm::mat3{ ObjectTransformation }))](auto&& EyePoint, auto&& RayDirection) {
-			auto [ObjectSpaceEyePoint, ObjectSpaceRayDirection] = [&] {
-				auto [HomogenizedEyePoint, HomogenizedRayDirection] = std::tuple{ glm::vec4{ EyePoint, 1 }, glm::vec4{ RayDirection, 0 } };
-				return std::tuple{ glm::vec3{ InverseTransformation * HomogenizedEyePoint }, glm::vec3{ InverseTransformation * HomogenizedRayDirection } };
-			}();
-			if (auto [t, SurfaceNormal] = ImplicitFunction(ObjectSpaceEyePoint, ObjectSpaceRayDirection); t != Ray::NoIntersection)
-				return std::tuple{ t, glm::normalize(NormalTransformation * SurfaceNormal) };
-			return std::tuple{ Ray::NoIntersection, glm::vec3{} };
-		};
+		return ImplicitFunctions::Transform(glm::inverse(ObjectTransformation), glm::inverse(glm::transpose(glm::mat3{ ObjectTransformation })), ImplicitFunction);
 	}
 }
 
@@ -201,6 +244,91 @@ namespace ImplicitFunctions::Solvers {
 			return std::tuple{ Ray::NoIntersection, glm::vec3{} };
 		};
 	}
+
+	// visits the real roots of a polynomial inside [Lower, Upper] in ascending order until Visitor returns true, and
+	// reports whether it did; coefficients are listed from the highest degree down. the roots of the derivative, visited
+	// the same way, split the interval into monotonic pieces that bracket at most one root each, which Newton steps then
+	// pin down, falling back to bisection whenever a step leaves the bracket. unlike Ferrari's closed form for quartics
+	// nothing here cancels catastrophically, and since pieces are examined lazily, finding the nearest root of a quartic
+	// usually costs a single root of its derivative.
+	auto PolynomialRoots(const auto& Coefficients, double Lower, double Upper, auto&& Visitor)->bool {
+		constexpr auto CoefficientCount = std::tuple_size_v<std::decay_t<decltype(Coefficients)>>;
+		auto Visit = [&](auto Root) {
+			return Lower <= Root && Root <= Upper && Visitor(Root);
+		};
+		if constexpr (CoefficientCount == 2)
+			return Coefficients[0] != 0 && Visit(-Coefficients[1] / Coefficients[0]);
+		else if constexpr (CoefficientCount == 3) {
+			// the root of larger magnitude is taken first so the other one does not suffer from cancellation
+			auto [a, b, c] = Coefficients;
+			if (a == 0)
+				return b != 0 && Visit(-c / b);
+			if (auto Discriminant = b * b - 4 * a * c; Discriminant >= 0) {
+				auto q = -(b + std::copysign(std::sqrt(Discriminant), b)) / 2;
+				auto [FirstRoot, SecondRoot] = std::tuple{ q / a, q != 0 ? c / q : q / a };
+				return Visit(Arithmetic::Min(FirstRoot, SecondRoot)) || Visit(Arithmetic::Max(FirstRoot, SecondRoot));
+			}
+			return false;
+		}
+		else {
+			auto Evaluate = [&](auto t) {
+				auto [Value, Slope] = std::tuple{ 0., 0. };
+				for (auto x : Coefficients)
+					std::tie(Value, Slope) = std::tuple{ Value * t + x, Slope * t + Value };
+				return std::tuple{ Value, Slope };
+			};
+			auto Refine = [&](auto Startpoint, auto Endpoint, auto StartpointValue) {
+				for (auto [t, _] = std::tuple{ (Startpoint + Endpoint) / 2, 0 }; _ < 64; ++_) {
+					auto [Value, Slope] = Evaluate(t);
+					if (Value == 0)
+						return t;
+					(Value < 0) == (StartpointValue < 0) ? Startpoint = t : Endpoint = t;
+					auto NextGuess = t - Value / Slope;
+					if ((NextGuess > Startpoint && NextGuess < Endpoint) == false)
+						NextGuess = (Startpoint + Endpoint) / 2;
+					if (std::abs(NextGuess - t) <= 1e-9 * (1 + std::abs(t)))
+						return NextGuess;
+					t = NextGuess;
+				}
+				return (Startpoint + Endpoint) / 2;
+			};
+
+			auto [Startpoint, StartpointValue] = std::tuple{ Lower, std::get<0>(Evaluate(Lower)) };
+			auto VisitPiece = [&](auto Endpoint) {
+				auto EndpointValue = std::get<0>(Evaluate(Endpoint));
+				auto Stopped = StartpointValue == 0 ? Visit(Startpoint) : StartpointValue * EndpointValue < 0 && Visit(Refine(Startpoint, Endpoint, StartpointValue));
+				std::tie(Startpoint, StartpointValue) = std::tuple{ Endpoint, EndpointValue };
+				return Stopped;
+			};
+			auto Derivative = std::array<double, CoefficientCount - 1>{};
+			for (auto x : Range{ CoefficientCount - 1 })
+				Derivative[x] = Coefficients[x] * static_cast<double>(CoefficientCount - 1 - x);
+			return PolynomialRoots(Derivative, Lower, Upper, VisitPiece) || VisitPiece(Upper) || (StartpointValue == 0 && Visit(Startpoint));
+		}
+	}
+
+	// the stretch [entry, exit] of the ray inside an axis aligned box, empty (entry > exit) for rays that miss it.
+	auto BoundingSlab(glm::dvec3 Lower, glm::dvec3 Upper) {
+		return [=](auto&& EyePoint, auto&& RayDirection) {
+			auto [NearDistances, FarDistances] = std::tuple{ (Lower - glm::dvec3{ EyePoint }) / glm::dvec3{ RayDirection }, (Upper - glm::dvec3{ EyePoint }) / glm::dvec3{ RayDirection } };
+			auto [Entry, Exit] = std::tuple{ glm::min(NearDistances, FarDistances), glm::max(NearDistances, FarDistances) };
+			return std::tuple{ std::max({ Entry.x, Entry.y, Entry.z, 0. }), std::min({ Exit.x, Exit.y, Exit.z }) };
+		};
+	}
+
+	// only rays entering the bounding slab pay for the quartic, which is re-expanded around the entry point first:
+	// the coefficients then stay on the scale of the shape, where a distant eye point would make them cancel.
+	auto Quartic(auto&& CoefficientGenerator, auto&& NormalGenerator, auto&& BoundingSlab) {
+		return [=](auto&& EyePoint, auto&& RayDirection) {
+			auto [Entry, Exit] = BoundingSlab(EyePoint, RayDirection);
+			if ((Entry <= Exit) == false)
+				return std::tuple{ Ray::NoIntersection, glm::vec3{} };
+			auto [EntryPoint, NearestRoot] = std::tuple{ glm::dvec3{ EyePoint } + Entry * glm::dvec3{ RayDirection }, 0. };
+			if (PolynomialRoots(CoefficientGenerator(EntryPoint, glm::dvec3{ RayDirection }), 0., Exit - Entry, [&](auto Root) { NearestRoot = Root; return true; }))
+				return std::tuple{ Entry + NearestRoot, NormalGenerator(glm::vec3{ EntryPoint + NearestRoot * glm::dvec3{ RayDirection } }) };
+			return std::tuple{ Ray::NoIntersection, glm::vec3{} };
+		};
+	}
 	auto Planar(auto&& NormalGenerator, auto MainAxis, auto ...SupportAxes) {
 		return [=](auto PlaneCoordinate, auto&& Constraint) {
 			return [=, SurfaceNormal = NormalGenerator(PlaneCoordinate)](auto&& EyePoint, auto&& RayDirection) {
@@ -264,4 +392,26 @@ namespace ImplicitFunctions::Standard {
 		[](auto&& IntersectionPosition) { return glm::normalize(glm::vec3{ 2 * IntersectionPosition.x, 0.25 - 0.5 * IntersectionPosition.y, 2 * IntersectionPosition.z }); },
 		Constraints::BoundedHeight
 	) + Solvers::XZPlane(-0.5, Constraints::CircularPlane);
+	// a ring of radius 0.375 around the y axis with a tube of radius 0.125, filling the unit cube horizontally.
+	inline auto Torus = Solvers::Quartic(
+		[](auto&& EyePoint, auto&& RayDirection) {
+			auto [MajorRadius, MinorRadius] = std::tuple{ 0.375, 0.125 };
+			auto [m, n, k] = std::tuple{ glm::dot(RayDirection, RayDirection), glm::dot(EyePoint, RayDirection), glm::dot(EyePoint, EyePoint) + MajorRadius * MajorRadius - MinorRadius * MinorRadius };
+			auto Ring = 4 * MajorRadius * MajorRadius;
+			return std::array{
+				m * m,
+				4 * m * n,
+				2 * m * k + 4 * n * n - Ring * (RayDirection.x * RayDirection.x + RayDirection.z * RayDirection.z),
+				4 * n * k - 2 * Ring * (EyePoint.x * RayDirection.x + EyePoint.z * RayDirection.z),
+				k * k - Ring * (EyePoint.x * EyePoint.x + EyePoint.z * EyePoint.z)
+			};
+		},
+		[](auto&& IntersectionPosition) {
+			auto [MajorRadius, MinorRadius] = std::tuple{ 0.375f, 0.125f };
+			auto s = glm::dot(IntersectionPosition, IntersectionPosition) + MajorRadius * MajorRadius - MinorRadius * MinorRadius;
+			auto t = s - 2 * MajorRadius * MajorRadius;
+			return glm::normalize(glm::vec3{ IntersectionPosition.x * t, IntersectionPosition.y * s, IntersectionPosition.z * t });
+		},
+		Solvers::BoundingSlab({ -0.5, -0.125, -0.5 }, { 0.5, 0.125, 0.5 })
+	);
 }
\ No newline at end of file
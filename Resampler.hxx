@@ -0,0 +1,98 @@
+#pragma once
+#include "Filter.hxx"
+#include <span>
+
+namespace Filter {
+	template<typename WeightFunctionType>
+	struct ResamplingKernel {
+		double Support;
+		WeightFunctionType Weight;
+	};
+}
+
+namespace Filter::ResamplingKernels {
+	inline auto Triangle = ResamplingKernel{ .Support = 1., .Weight = [](double x) { return Arithmetic::Max(1 - std::abs(x), 0.); } };
+	inline auto Lanczos3 = ResamplingKernel{ .Support = 3., .Weight = [](double x) {
+		auto Sinc = [](auto x) { return x == 0 ? 1. : std::sin(std::numbers::pi * x) / (std::numbers::pi * x); };
+		return std::abs(x) < 3 ? Sinc(x) * Sinc(x / 3) : 0.;
+	} };
+	inline auto BicubicFamily = [](double B, double C) {
+		return ResamplingKernel{ .Support = 2., .Weight = [=](double x) {
+			if (x = std::abs(x); x < 1)
+				return ((12 - 9 * B - 6 * C) * x * x * x + (-18 + 12 * B + 6 * C) * x * x + (6 - 2 * B)) / 6;
+			else if (x < 2)
+				return ((-B - 6 * C) * x * x * x + (6 * B + 30 * C) * x * x + (-12 * B - 48 * C) * x + (8 * B + 24 * C)) / 6;
+			else
+				return 0.;
+		} };
+	};
+	inline auto Mitchell = BicubicFamily(1. / 3, 1. / 3);
+	inline auto CatmullRom = BicubicFamily(0., 0.5);
+}
+
+namespace Filter {
+	struct ResamplingWeightTable {
+		field(TapCount, 0_z);
+		field(Startpoints, std::vector<std::ptrdiff_t>{});
+		field(Weights, std::vector<float>{});
+
+	public:
+		ResamplingWeightTable(std::ptrdiff_t InputLength, std::ptrdiff_t OutputLength, auto&& Kernel) {
+			auto Scale = static_cast<double>(InputLength) / OutputLength;
+			auto KernelScale = Arithmetic::Max(Scale, 1.);
+			TapCount = Arithmetic::Min(static_cast<std::ptrdiff_t>(std::ceil(2 * Kernel.Support * KernelScale)) + 1, InputLength);
+			Startpoints.resize(OutputLength);
+			Weights.resize(OutputLength * TapCount);
+			for (auto x : Range{ OutputLength }) {
+				auto Center = (x + 0.5) * Scale - 0.5;
+				auto Startpoint = std::clamp(static_cast<std::ptrdiff_t>(std::floor(Center - Kernel.Support * KernelScale)) + 1, 0_z, InputLength - TapCount);
+				auto TapWeights = std::span{ Weights }.subspan(x * TapCount, TapCount);
+				for (auto Tap : Range{ TapCount })
+					TapWeights[Tap] = static_cast<float>(Kernel.Weight((Startpoint + Tap - Center) / KernelScale));
+				if (auto WeightSum = std::accumulate(TapWeights.begin(), TapWeights.end(), 0.); WeightSum != 0)
+					for (auto& Weight : TapWeights)
+						Weight = static_cast<float>(Weight / WeightSum);
+				Startpoints[x] = Startpoint;
+			}
+		}
+	};
+
+	// separable resampling to any size: a horizontal pass into an intermediate of the input height, then a vertical pass.
+	// near the borders the tap window is shifted back inside the frame, dropping the taps that fall off, and renormalized.
+	template<typename PixelType = float>
+	auto Resample(auto&& Image, std::ptrdiff_t OutputHeight, std::ptrdiff_t OutputWidth, auto&& Kernel, auto&& ExecutionPolicy) {
+		auto [PlaneCount, InputHeight, InputWidth] = std::array{ static_cast<std::ptrdiff_t>(Image.PlaneCount), static_cast<std::ptrdiff_t>(Image[0].Height), static_cast<std::ptrdiff_t>(Image[0].Width) };
+		auto [HorizontalWeights, VerticalWeights] = std::tuple{ ResamplingWeightTable{ InputWidth, OutputWidth, Kernel }, ResamplingWeightTable{ InputHeight, OutputHeight, Kernel } };
+		auto ForEachRow = [&](auto Height, auto&& RowProcessor) {
+			auto Rows = std::vector<std::ptrdiff_t>(Height);
+			std::iota(Rows.begin(), Rows.end(), 0_z);
+			std::for_each(ExecutionPolicy, Rows.begin(), Rows.end(), RowProcessor);
+		};
+		auto HorizontallyResampledImage = Frame{ InputHeight, OutputWidth, PlaneCount };
+		ForEachRow(InputHeight, [&](auto y) {
+			for (auto c : Range{ PlaneCount })
+				for (auto [SourceRow, ResampledRow] = std::tuple{ Image[c].DirectAccess()[y], HorizontallyResampledImage[c][y] }; auto x : Range{ OutputWidth }) {
+					auto [Startpoint, TapWeights] = std::tuple{ HorizontalWeights.Startpoints[x], HorizontalWeights.Weights.data() + x * HorizontalWeights.TapCount };
+					auto AccumulatedValue = 0.f;
+					for (auto Tap : Range{ HorizontalWeights.TapCount })
+						AccumulatedValue += TapWeights[Tap] * SourceRow[Startpoint + Tap];
+					ResampledRow[x] = AccumulatedValue;
+				}
+		});
+		auto IntermediateImage = HorizontallyResampledImage.Finalize();
+		auto ResampledImage = Frame<PixelType>{ OutputHeight, OutputWidth, PlaneCount };
+		ForEachRow(OutputHeight, [&](auto y) {
+			auto AccumulatedRow = std::vector<float>(OutputWidth);
+			auto [Startpoint, TapWeights] = std::tuple{ VerticalWeights.Startpoints[y], VerticalWeights.Weights.data() + y * VerticalWeights.TapCount };
+			for (auto c : Range{ PlaneCount }) {
+				std::fill(AccumulatedRow.begin(), AccumulatedRow.end(), 0.f);
+				for (auto Tap : Range{ VerticalWeights.TapCount })
+					for (auto SourceRow = IntermediateImage[c].DirectAccess()[Startpoint + Tap]; auto x : Range{ OutputWidth })
+						AccumulatedRow[x] += TapWeights[Tap] * SourceRow[x];
+				for (auto ResampledRow = ResampledImage[c][y]; auto x : Range{ OutputWidth })
+					ResampledRow[x] = AccumulatedRow[x];
+			}
+		});
+		return ResampledImage.Finalize();
+	}
+}
\ No newline at end of file
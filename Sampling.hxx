@@ -0,0 +1,41 @@
+﻿#pragma once
+#include "Infrastructure.hxx"
+
+namespace Sampling::Patterns {
+	inline auto Stratified = [](std::ptrdiff_t Index, std::ptrdiff_t Count) {
+		auto Rows = Arithmetic::Max(static_cast<std::ptrdiff_t>(std::round(std::sqrt(Count))), 1_z);
+		auto RowStartpoint = [&](auto Row) { return (Row * Count + Rows - 1) / Rows; };
+		auto Row = Index * Rows / Count;
+		auto SamplesInRow = RowStartpoint(Row + 1) - RowStartpoint(Row);
+		return std::array{ (Index - RowStartpoint(Row) + 0.5) / SamplesInRow, (Row + 0.5) / Rows, 1. / (Rows * SamplesInRow) };
+	};
+	inline auto R2 = [](std::ptrdiff_t Index, std::ptrdiff_t Count) {
+		constexpr auto PlasticNumber = 1.32471795724474602596;
+		return std::array{ std::fmod(0.5 + Index / PlasticNumber, 1.), std::fmod(0.5 + Index / (PlasticNumber * PlasticNumber), 1.), 1. / Count };
+	};
+	inline auto Aperture = [](std::ptrdiff_t Index, std::ptrdiff_t Count) {
+		constexpr auto GeneratorOfR4 = 1.16730397826141868425;
+		return std::array{ std::fmod(0.5 + Index / std::pow(GeneratorOfR4, 3), 1.), std::fmod(0.5 + Index / std::pow(GeneratorOfR4, 4), 1.), 1. / Count };
+	};
+}
+
+namespace Sampling::Warps {
+	inline auto ConcentricDisk = [](auto u, auto v) {
+		auto [a, b] = std::array{ 2 * u - 1, 2 * v - 1 };
+		if (a == 0 && b == 0)
+			return std::array{ 0., 0. };
+		auto [r, φ] = std::abs(a) > std::abs(b) ? std::array{ a, std::numbers::pi / 4 * (b / a) } : std::array{ b, std::numbers::pi / 2 - std::numbers::pi / 4 * (a / b) };
+		return std::array{ r * std::cos(φ), r * std::sin(φ) };
+	};
+}
+
+namespace Sampling::ReconstructionFilters {
+	inline auto QuadraticBSpline = [](auto u) {
+		if (u < 1. / 6)
+			return std::cbrt(6 * u) - 1.5;
+		else if (u > 5. / 6)
+			return 1.5 - std::cbrt(6 * (1 - u));
+		else
+			return std::sqrt(3.) * std::cos(std::acos(std::sqrt(3.) * (1 - 2 * u) / 1.5) / 3 - 2 * std::numbers::pi / 3);
+	};
+}
\ No newline at end of file
@@ -0,0 +1,128 @@
+#pragma once
+#include "Ray.hxx"
+
+namespace Textures {
+	inline auto SRGBDecodingTable = [] {
+		auto Table = std::array<float, 256>{};
+		for (auto x : Range{ std::ssize(Table) })
+			if (auto EncodedIntensity = x / 255.; EncodedIntensity <= 0.04045)
+				Table[x] = EncodedIntensity / 12.92;
+			else
+				Table[x] = std::pow((EncodedIntensity + 0.055) / 1.055, 2.4);
+		return Table;
+	}();
+
+	// one level of a mip pyramid, with texels laid out in square tiles rather than rows, so the 2×2 neighborhood
+	// of a bilinear lookup (and the next lookups of nearby rays) mostly falls into the same few cache lines.
+	struct MipLevel {
+		static constexpr auto TileSize = 8_z;
+		field(Height, 0_z);
+		field(Width, 0_z);
+		field(TileColumnCount, 0_z);
+		field(Texels, std::vector<glm::vec3>{});
+
+	public:
+		MipLevel() = default;
+		MipLevel(std::ptrdiff_t Height, std::ptrdiff_t Width) : Height{ Height }, Width{ Width }, TileColumnCount{ (Width + TileSize - 1) / TileSize } {
+			Texels.resize(TileColumnCount * ((Height + TileSize - 1) / TileSize) * TileSize * TileSize);
+		}
+		auto Index(std::ptrdiff_t y, std::ptrdiff_t x) const {
+			return ((y / TileSize) * TileColumnCount + x / TileSize) * TileSize * TileSize + (y % TileSize) * TileSize + x % TileSize;
+		}
+		auto& operator()(std::ptrdiff_t y, std::ptrdiff_t x) {
+			return Texels[Index(y, x)];
+		}
+		auto& operator()(std::ptrdiff_t y, std::ptrdiff_t x) const {
+			return Texels[Index(y, x)];
+		}
+
+		// bilinear, repeating outside [0, 1); v runs from the bottom row of the image up.
+		auto Sample(double u, double v) const {
+			auto [x, y] = std::tuple{ u * Width - 0.5, (1 - v) * Height - 0.5 };
+			auto [Left, Top] = std::tuple{ std::floor(x), std::floor(y) };
+			auto [Horizontal, Vertical] = std::tuple{ static_cast<float>(x - Left), static_cast<float>(y - Top) };
+			auto Wrap = [](auto Coordinate, auto Length) {
+				auto Remainder = static_cast<std::ptrdiff_t>(std::fmod(Coordinate, static_cast<double>(Length)));
+				return Remainder < 0 ? Remainder + Length : Remainder;
+			};
+			auto [x0, y0] = std::tuple{ Wrap(Left, Width), Wrap(Top, Height) };
+			auto [x1, y1] = std::tuple{ x0 + 1 == Width ? 0 : x0 + 1, y0 + 1 == Height ? 0 : y0 + 1 };
+			auto UpperRow = glm::mix((*this)(y0, x0), (*this)(y0, x1), Horizontal);
+			auto LowerRow = glm::mix((*this)(y1, x0), (*this)(y1, x1), Horizontal);
+			return glm::mix(UpperRow, LowerRow, Vertical);
+		}
+	};
+
+	// an image decoded to linear intensities, with the finest level first and every further level a 2×2 box
+	// filtered half of the previous one (rounding up, with the last row or column repeated), down to one texel.
+	struct MipMappedTexture {
+		field(Levels, std::vector<MipLevel>{});
+
+	public:
+		MipMappedTexture() = default;
+		MipMappedTexture(std::ptrdiff_t Height, std::ptrdiff_t Width, auto&& Pixels) {
+			Levels.emplace_back(Height, Width);
+			for (auto y : Range{ Height })
+				for (auto x : Range{ Width }) {
+					auto&& Pixel = Pixels[y * Width + x];
+					Levels[0](y, x) = { SRGBDecodingTable[Pixel.r], SRGBDecodingTable[Pixel.g], SRGBDecodingTable[Pixel.b] };
+				}
+			while (Levels.back().Height > 1 || Levels.back().Width > 1) {
+				auto& FinerLevel = Levels.back();
+				auto CoarserLevel = MipLevel{ (FinerLevel.Height + 1) / 2, (FinerLevel.Width + 1) / 2 };
+				for (auto y : Range{ CoarserLevel.Height })
+					for (auto x : Range{ CoarserLevel.Width }) {
+						auto [y0, y1] = std::tuple{ 2 * y, Arithmetic::Min(2 * y + 1, FinerLevel.Height - 1) };
+						auto [x0, x1] = std::tuple{ 2 * x, Arithmetic::Min(2 * x + 1, FinerLevel.Width - 1) };
+						CoarserLevel(y, x) = (FinerLevel(y0, x0) + FinerLevel(y0, x1) + FinerLevel(y1, x0) + FinerLevel(y1, x1)) / 4.f;
+					}
+				Levels.push_back(std::move(CoarserLevel));
+			}
+		}
+
+		// trilinear; Footprint is the width of the region to average over, in texels of the finest level.
+		auto Sample(double u, double v, double Footprint) const {
+			auto LevelOfDetail = std::clamp(std::log2(Arithmetic::Max(Footprint, 1.)), 0., std::ssize(Levels) - 1.);
+			auto FinerLevel = static_cast<std::ptrdiff_t>(LevelOfDetail);
+			auto CoarserLevel = Arithmetic::Min(FinerLevel + 1, std::ssize(Levels) - 1);
+			return glm::mix(Levels[FinerLevel].Sample(u, v), Levels[CoarserLevel].Sample(u, v), static_cast<float>(LevelOfDetail - FinerLevel));
+		}
+	};
+
+	// a null entry records an image that failed to load, so the failure is reported once and not retried.
+	inline auto Cache = SharedCache<std::shared_ptr<const MipMappedTexture>>{};
+}
+
+// (u, v) coordinates of points on the standard shapes, in their object space. curved sides wrap u once around
+// the y axis and run v up the height; flat faces and caps are mapped as seen from outside, upright where possible.
+namespace Textures::Mappings {
+	auto Azimuth(auto&& Position) {
+		auto u = std::atan2(-Position.z, Position.x) / (2 * std::numbers::pi);
+		return u < 0 ? u + 1 : u;
+	}
+	auto Cap(auto&& Position) {
+		return glm::dvec2{ Position.x + 0.5, Position.y > 0 ? 0.5 - Position.z : Position.z + 0.5 };
+	}
+
+	inline auto Cube = [](auto&& Position) {
+		if (auto Magnitude = glm::abs(Position); Magnitude.x >= Magnitude.y && Magnitude.x >= Magnitude.z)
+			return glm::dvec2{ Position.x > 0 ? 0.5 - Position.z : Position.z + 0.5, Position.y + 0.5 };
+		else if (Magnitude.y >= Magnitude.z)
+			return Cap(Position);
+		else
+			return glm::dvec2{ Position.z > 0 ? Position.x + 0.5 : 0.5 - Position.x, Position.y + 0.5 };
+	};
+	inline auto Sphere = [](auto&& Position) {
+		return glm::dvec2{ Azimuth(Position), std::asin(std::clamp(2. * Position.y, -1., 1.)) / std::numbers::pi + 0.5 };
+	};
+	inline auto Cylinder = [](auto&& Position) {
+		if (std::abs(Position.y) >= 0.5 - 1e-4)
+			return Cap(Position);
+		return glm::dvec2{ Azimuth(Position), Position.y + 0.5 };
+	};
+	inline auto Cone = Cylinder;
+	inline auto Torus = [](auto&& Position) {
+		auto v = std::atan2(Position.y, std::hypot(Position.x, Position.z) - 0.375) / (2 * std::numbers::pi);
+		return glm::dvec2{ Azimuth(Position), v < 0 ? v + 1 : v };
+	};
+}
\ No newline at end of file
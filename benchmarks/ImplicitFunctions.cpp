@@ -0,0 +1,62 @@
+#include "Ray.hxx"
+#include <chrono>
+#include <iostream>
+#include <iomanip>
+#include <random>
+
+// times the closest hit of every standard implicit function over the same rays, all in object space.
+// "aimed" rays pass through a random point of the unit cube, so most of them hit; "scattered" rays pass
+// through a random point of a box four times as wide, so most of them miss, which is where early-outs pay off.
+auto GenerateRays(std::ptrdiff_t RayCount, double TargetExtent, std::uint32_t Seed) {
+    auto Generator = std::mt19937{ Seed };
+    auto Uniform = std::uniform_real_distribution<float>{ -1, 1 };
+    auto Rays = std::vector<std::tuple<glm::vec3, glm::vec3>>(RayCount);
+    for (auto& [EyePoint, RayDirection] : Rays) {
+        EyePoint = 3.f * glm::normalize(glm::vec3{ Uniform(Generator), Uniform(Generator), Uniform(Generator) });
+        auto Target = static_cast<float>(TargetExtent / 2) * glm::vec3{ Uniform(Generator), Uniform(Generator), Uniform(Generator) };
+        RayDirection = glm::normalize(Target - EyePoint);
+    }
+    return Rays;
+}
+
+auto Measure(auto&& ImplicitFunction, auto&& Rays) {
+    auto [HitCount, DistanceSum] = std::tuple{ 0_z, 0. };
+    auto Startpoint = std::chrono::steady_clock::now();
+    for (auto&& [EyePoint, RayDirection] : Rays)
+        if (auto [t, SurfaceNormal] = ImplicitFunction(EyePoint, RayDirection); t != Ray::NoIntersection) {
+            ++HitCount;
+            DistanceSum += t + SurfaceNormal.x;
+        }
+    auto Elapsed = std::chrono::duration<double, std::nano>{ std::chrono::steady_clock::now() - Startpoint }.count();
+    return std::tuple{ Elapsed / std::ssize(Rays), static_cast<double>(HitCount) / std::ssize(Rays), DistanceSum };
+}
+
+int main(int argc, char* argv[]) {
+    auto RayCount = argc > 1 ? std::atoll(argv[1]) : 1'000'000ll;
+    auto RaySets = std::array{
+        std::tuple{ "aimed", GenerateRays(RayCount, 1, 1) },
+        std::tuple{ "scattered", GenerateRays(RayCount, 4, 2) }
+    };
+    auto Kernels = std::tuple{
+        std::tuple{ "Sphere", ImplicitFunctions::Standard::Sphere },
+        std::tuple{ "Cylinder", ImplicitFunctions::Standard::Cylinder },
+        std::tuple{ "Cone", ImplicitFunctions::Standard::Cone },
+        std::tuple{ "Cube", ImplicitFunctions::Standard::Cube },
+        std::tuple{ "Torus", ImplicitFunctions::Standard::Torus }
+    };
+
+    auto Checksum = 0.;
+    std::cout << RayCount << " rays per set" << std::endl;
+    std::cout << std::left << std::setw(10) << "kernel" << std::setw(12) << "rays" << std::setw(10) << "ns/ray" << "hit rate" << std::endl;
+    std::apply([&](auto&& ...Kernel) {
+        auto Report = [&](auto&& Name, auto&& ImplicitFunction) {
+            for (auto&& [RaySetName, Rays] : RaySets) {
+                auto [Nanoseconds, HitRate, DistanceSum] = Measure(ImplicitFunction, Rays);
+                Checksum += DistanceSum;
+                std::cout << std::left << std::setw(10) << Name << std::setw(12) << RaySetName << std::setw(10) << std::fixed << std::setprecision(1) << Nanoseconds << std::setprecision(3) << HitRate << std::endl;
+            }
+        };
+        (std::apply(Report, Kernel), ...);
+    }, Kernels);
+    std::cout << "checksum " << Checksum << std::endl;
+}
@@ -0,0 +1,87 @@
+#include "Ray.hxx"
+#include <iostream>
+#include <iomanip>
+#include <random>
+#include <optional>
+
+// checks the torus kernel against a brute-force reference: the implicit function is evaluated in long double on a fine
+// sweep of the ray's span inside the bounding slab, and the first sign change is bisected down to the last bit. eye points
+// sit anywhere from 1 to 1000 units away, log-uniformly, and aim at a random point of the unit cube.
+constexpr auto MajorRadius = 0.375L;
+constexpr auto MinorRadius = 0.125L;
+constexpr auto SweepSteps = 4096;
+
+auto TorusFunction(long double x, long double y, long double z) {
+    auto s = x * x + y * y + z * z + MajorRadius * MajorRadius - MinorRadius * MinorRadius;
+    return s * s - 4 * MajorRadius * MajorRadius * (x * x + z * z);
+}
+
+auto ReferenceRoot(const glm::vec3& EyePoint, const glm::vec3& RayDirection) {
+    auto Evaluate = [&](long double t) {
+        return TorusFunction(EyePoint.x + t * RayDirection.x, EyePoint.y + t * RayDirection.y, EyePoint.z + t * RayDirection.z);
+    };
+    auto [Entry, Exit] = std::tuple{ 0.L, std::numeric_limits<long double>::infinity() };
+    for (auto [Axis, Extent] : std::array{ std::tuple{ 0, 0.5L }, std::tuple{ 1, 0.125L }, std::tuple{ 2, 0.5L } }) {
+        auto [Origin, Direction] = std::tuple{ static_cast<long double>(EyePoint[Axis]), static_cast<long double>(RayDirection[Axis]) };
+        if (Direction == 0) {
+            if (std::abs(Origin) > Extent)
+                return std::optional<long double>{};
+            continue;
+        }
+        auto [Near, Far] = std::array{ (-Extent - Origin) / Direction, (Extent - Origin) / Direction };
+        if (Near > Far)
+            std::swap(Near, Far);
+        std::tie(Entry, Exit) = std::tuple{ Arithmetic::Max(Entry, Near), Arithmetic::Min(Exit, Far) };
+    }
+    if (Entry > Exit)
+        return std::optional<long double>{};
+    for (auto [Lower, LowerValue] = std::tuple{ Entry, Evaluate(Entry) }; auto Step : Range{ 1, SweepSteps + 1 }) {
+        auto Upper = Entry + (Exit - Entry) * Step / SweepSteps;
+        if (auto UpperValue = Evaluate(Upper); (LowerValue > 0) != (UpperValue > 0)) {
+            for (auto _ : Range{ 128 })
+                if (auto Midpoint = (Lower + Upper) / 2; (Evaluate(Midpoint) > 0) == (LowerValue > 0))
+                    Lower = Midpoint;
+                else
+                    Upper = Midpoint;
+            return std::optional{ (Lower + Upper) / 2 };
+        }
+        else
+            std::tie(Lower, LowerValue) = std::tuple{ Upper, UpperValue };
+    }
+    return std::optional<long double>{};
+}
+
+int main(int argc, char* argv[]) {
+    auto RayCount = argc > 1 ? std::atoll(argv[1]) : 100'000ll;
+    auto Generator = std::mt19937{ 3 };
+    auto [Uniform, LogDistance] = std::tuple{ std::uniform_real_distribution<float>{ -1, 1 }, std::uniform_real_distribution<float>{ 0, 3 } };
+    auto [HitCount, MissedCount, MisplacedCount, SpuriousCount, GrazingCount] = std::array{ 0_z, 0_z, 0_z, 0_z, 0_z };
+    auto MaximumRelativeError = 0.L;
+    for (auto _ : Range{ RayCount }) {
+        auto EyePoint = std::pow(10.f, LogDistance(Generator)) * glm::normalize(glm::vec3{ Uniform(Generator), Uniform(Generator), Uniform(Generator) });
+        auto Target = 0.5f * glm::vec3{ Uniform(Generator), Uniform(Generator), Uniform(Generator) };
+        auto RayDirection = glm::normalize(Target - EyePoint);
+        auto [t, SurfaceNormal] = ImplicitFunctions::Standard::Torus(EyePoint, RayDirection);
+        auto Reference = ReferenceRoot(EyePoint, RayDirection);
+        if (Reference && t != Ray::NoIntersection) {
+            ++HitCount;
+            auto RelativeError = std::abs(t - *Reference) / Arithmetic::Max(*Reference, 1.L);
+            MaximumRelativeError = Arithmetic::Max(MaximumRelativeError, RelativeError);
+            MisplacedCount += RelativeError > 1e-6;
+        }
+        else if (Reference)
+            ++MissedCount;
+        else if (t != Ray::NoIntersection) {
+            // a tangent hit touches the surface without crossing it, so the sweep sees no sign change there
+            auto Position = glm::dvec3{ EyePoint } + t * glm::dvec3{ RayDirection };
+            if (std::abs(TorusFunction(Position.x, Position.y, Position.z)) < 1e-9)
+                ++GrazingCount;
+            else
+                ++SpuriousCount;
+        }
+    }
+    std::cout << RayCount << " rays, " << HitCount << " hits, " << GrazingCount << " tangent hits" << std::endl;
+    std::cout << "missed " << MissedCount << ", misplaced " << MisplacedCount << ", spurious " << SpuriousCount << std::endl;
+    std::cout << "largest relative error " << std::scientific << std::setprecision(2) << static_cast<double>(MaximumRelativeError) << std::endl;
+    return MissedCount + MisplacedCount + SpuriousCount == 0 ? 0 : 1;
+}
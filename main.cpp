@@ -6,7 +6,12 @@
 #include <iostream>
 #include "utils/RGBA.h"
 #include "utils/SceneParser.h"
+#include "utils/CompiledScene.h"
+#include "utils/CompiledMesh.h"
+#include "utils/TextureImage.h"
 #include "raytracer/RayTracer.hxx"
+#include "ImageOutput.hxx"
+#include "Resampler.hxx"
 
 template<typename PointerType>
 struct PlaneView {
@@ -27,6 +32,8 @@ int main(int argc, char *argv[])
     QCommandLineParser parser;
     parser.addHelpOption();
     parser.addPositionalArgument("config", "Path of the config file.");
+    parser.addOption({ "compile", "Compile the scene of the config into a binary scene file and exit.", "path" });
+    parser.addOption({ "compile-mesh", "Compile the OBJ file given in place of the config into a memory-mapped mesh file and exit.", "path" });
     parser.process(a);
 
     auto positionalArgs = parser.positionalArguments();
@@ -36,12 +43,34 @@ int main(int argc, char *argv[])
         return 1;
     }
 
+    if (parser.isSet("compile-mesh")) {
+        bool compiled = false;
+        try {
+            auto mesh = Meshes::QuantizedMesh{ *Meshes::Load(positionalArgs[0].toStdString()) };
+            compiled = CompiledMesh::compile(mesh.Nodes, mesh.Leaves, mesh.LatticeOrigin, mesh.LatticeStep, static_cast<std::uint32_t>(mesh.TriangleCount),
+                                             parser.value("compile-mesh").toStdString());
+        }
+        catch (std::exception& Error) {
+            std::cerr << Error.what() << std::endl;
+        }
+        if (!compiled) {
+            std::cerr << "error compiling mesh: " << positionalArgs[0].toStdString() << std::endl;
+            a.exit(1);
+            return 1;
+        }
+        a.exit();
+        return 0;
+    }
+
     QSettings settings( positionalArgs[0], QSettings::IniFormat );
     QString iScenePath = settings.value("IO/scene").toString();
     QString oImagePath = settings.value("IO/output").toString();
 
+    // A compiled scene is mapped and used in place, anything else is parsed as XML
     RenderData metaData;
-    bool success = SceneParser::parse(iScenePath.toStdString(), metaData);
+    CompiledScene compiledScene;
+    bool isCompiledScene = CompiledScene::isCompiledScene(iScenePath.toStdString());
+    bool success = isCompiledScene ? compiledScene.load(iScenePath.toStdString()) : SceneParser::parse(iScenePath.toStdString(), metaData);
 
     if (!success) {
         std::cerr << "error loading scene: " << iScenePath.toStdString() << std::endl;
@@ -49,35 +78,175 @@ int main(int argc, char *argv[])
         return 1;
     }
 
+    if (parser.isSet("compile")) {
+        if (isCompiledScene || !CompiledScene::compile(metaData, parser.value("compile").toStdString())) {
+            std::cerr << "error compiling scene: " << iScenePath.toStdString() << std::endl;
+            a.exit(1);
+            return 1;
+        }
+        a.exit();
+        return 0;
+    }
+
     int width = settings.value("Canvas/width").toInt();
     int height = settings.value("Canvas/height").toInt();
+    int bandHeight = settings.value("Canvas/band-height", 0).toInt();
+    auto OutputFormat = QFileInfo(oImagePath).suffix().toLower();
+    auto isBandedOutput = bandHeight > 0 && (OutputFormat == "png" || OutputFormat == "ppm");
+    double renderScale = settings.value("Canvas/render-scale", 1.).toDouble();
+    if (isBandedOutput && renderScale != 1.) {
+        std::cerr << "Warning: Canvas/render-scale is ignored when rendering in bands" << std::endl;
+        renderScale = 1.;
+    }
+    int renderWidth = std::max(static_cast<int>(std::lround(width * renderScale)), 1);
+    int renderHeight = std::max(static_cast<int>(std::lround(height * renderScale)), 1);
+    RayTracer::Config::SamplesPerPixel = settings.value("Canvas/samples", 0).toInt();
+    RayTracer::Config::SamplePattern = settings.value("Canvas/pattern", "stratified").toString().toStdString();
+    RayTracer::Config::enableQualityMapDepth = settings.value("Canvas/quality-map-depth").toBool();
+    RayTracer::Config::enableSRGBEncoding = settings.value("Canvas/srgb").toBool();
+    RayTracer::Config::enableDithering = settings.value("Canvas/dither").toBool();
+    RayTracer::Config::enableHalfPrecisionSupersampling = settings.value("Canvas/half-supersample").toBool();
+    RayTracer::Config::ResamplingFilter = settings.value("Canvas/resampling-filter", "bilinear").toString().toStdString();
+    try {
+        RayTracer::WithResamplingKernel([](auto&&) {});
+    }
+    catch (std::exception& Error) {
+        std::cerr << Error.what() << std::endl;
+        a.exit(1);
+        return 1;
+    }
+
+    if (auto iQualityMapPath = settings.value("Canvas/quality-map").toString(); iQualityMapPath.isEmpty() == false) {
+        // the map is held at full frame size, which banded output exists to avoid
+        if (isBandedOutput) {
+            std::cerr << "Error: Canvas/quality-map cannot be used when rendering in bands" << std::endl;
+            a.exit(1);
+            return 1;
+        }
+        auto QualityImage = QImage(iQualityMapPath);
+        if (QualityImage.isNull()) {
+            std::cerr << "error loading quality map: " << iQualityMapPath.toStdString() << std::endl;
+            a.exit(1);
+            return 1;
+        }
+        QualityImage = QualityImage.convertToFormat(QImage::Format_Grayscale8).scaled(renderWidth, renderHeight, Qt::IgnoreAspectRatio, Qt::SmoothTransformation);
+        auto QualityMap = Filter::Frame{ renderHeight, renderWidth, 1 };
+        for (auto y : Range{ renderHeight })
+            for (auto x : Range{ renderWidth })
+                QualityMap[0][y][x] = QualityImage.constScanLine(y)[x] / 255.;
+        RayTracer::Config::QualityMap = QualityMap.Finalize();
+    }
 
     RayTracer::Config::enableShadow = settings.value("Feature/shadows").toBool();
     RayTracer::Config::enableReflection = settings.value("Feature/reflect").toBool();
     RayTracer::Config::enableRefraction = settings.value("Feature/refract").toBool();
     RayTracer::Config::enableTextureMap = settings.value("Feature/texture").toBool();
+    RayTracer::Config::SceneDirectory = QFileInfo(iScenePath).absolutePath().toStdString();
 
     RayTracer::Config::enableParallelism = settings.value("Feature/parallel").toBool();
     RayTracer::Config::enableSuperSample = settings.value("Feature/super-sample").toBool();
     RayTracer::Config::enableAcceleration = settings.value("Feature/acceleration").toBool();
     RayTracer::Config::enableDepthOfField = settings.value("Feature/depthoffield").toBool();
+    RayTracer::Config::MaximumLensSampleCount = settings.value("Feature/depthoffield-samples", 64).toInt();
+    RayTracer::Config::enableSampleAccumulation = settings.value("Feature/accumulate").toBool();
+    RayTracer::Config::enableAdaptiveSampling = settings.value("Feature/adaptive").toBool();
+    RayTracer::Config::AdaptiveSamplingThreshold = settings.value("Feature/adaptive-threshold", RayTracer::Config::AdaptiveSamplingThreshold).toDouble();
+    RayTracer::Config::enableDecoupledShading = settings.value("Feature/decoupled-shading").toBool();
+    RayTracer::Config::enableDenoising = settings.value("Feature/denoise").toBool();
+    RayTracer::Config::DenoisingIterations = settings.value("Feature/denoise-iterations", RayTracer::Config::DenoisingIterations).toInt();
+    if (RayTracer::Config::QualityMap.PlaneCount != 0 && !RayTracer::Config::enableSuperSample)
+        std::cerr << "Warning: Canvas/quality-map only sets recursion depth without Feature/super-sample, its sample budget is ignored" << std::endl;
 
-    QImage image = QImage(width, height, QImage::Format_RGBX8888);
-    image.fill(Qt::black);
-
-    auto data = reinterpret_cast<RGBA*>(image.bits());
     auto SupersamplingExponent = 2;
-    
+
+    auto ConfigurePNGWriter = [&](ImageOutput::PNGWriter& Writer) {
+        Writer.CompressionLevel = settings.value("IO/png-level", Writer.CompressionLevel).toInt();
+        Writer.FilterMethod = settings.value("IO/png-filter", QString::fromStdString(Writer.FilterMethod)).toString().toStdString();
+        Writer.enableParallelism = RayTracer::Config::enableParallelism;
+    };
+    auto SaveFrame = [&](const QString& Path, auto&& RenderedImage) {
+        auto [Height, Width] = std::tuple{ static_cast<int>(RenderedImage[0].Height), static_cast<int>(RenderedImage[0].Width) };
+        if (auto Format = QFileInfo(Path).suffix().toLower(); Format == "pfm")
+            return ImageOutput::WritePFM(Path.toStdString(), RenderedImage);
+        else if (Format == "exr")
+            return ImageOutput::WriteEXR(Path.toStdString(), RenderedImage);
+
+        QImage image = QImage(Width, Height, QImage::Format_RGBX8888);
+        auto data = reinterpret_cast<RGBA*>(image.bits());
+        auto Canvas = PlaneView<decltype(data)>{ .Data = data, .RowSize = Width };
+        RayTracer::Draw(Canvas, RenderedImage);
+        if (QFileInfo(Path).suffix().toLower() == "png") {
+            auto Writer = ImageOutput::PNGWriter{ Path.toStdString(), Height, Width };
+            ConfigurePNGWriter(Writer);
+            Writer.Append(Canvas, Height, Width);
+            return Writer.Finish();
+        }
+        auto saved = image.save(Path);
+        if (!saved) {
+            image.save(Path, "PNG");
+        }
+        return saved;
+    };
+    auto Resample = [&](auto&& Image, auto Height, auto Width) {
+        return RayTracer::WithResamplingKernel([&](auto&& Kernel) {
+            return RayTracer::WithExecutionPolicy([&](auto&& ExecutionPolicy) {
+                return Filter::Resample(Image, Height, Width, Kernel, ExecutionPolicy);
+            });
+        });
+    };
+
+    auto RenderScene = [&](auto&& metaData) {
+        auto RenderInBands = [&](auto&& Writer) {
+            auto sceneRecords = RayTracer::SceneRecords{ height, SupersamplingExponent, metaData };
+            for (auto BandStartpoint : Range{ 0, height, bandHeight }) {
+                auto RenderedBand = RayTracer::Render(height, width, SupersamplingExponent, metaData, sceneRecords, BandStartpoint, std::min<std::ptrdiff_t>(bandHeight, height - BandStartpoint));
+                auto BandCanvas = std::vector<RGBA>(width * RenderedBand[0].Height);
+                auto BandView = PlaneView<RGBA*>{ .Data = BandCanvas.data(), .RowSize = width };
+                RayTracer::Draw(BandView, RenderedBand);
+                Writer.Append(BandView, RenderedBand[0].Height, width);
+            }
+            return Writer.Finish();
+        };
+        if (isBandedOutput && OutputFormat == "png") {
+            auto Writer = ImageOutput::PNGWriter{ oImagePath.toStdString(), height, width };
+            ConfigurePNGWriter(Writer);
+            success = RenderInBands(Writer);
+        }
+        else if (isBandedOutput)
+            success = RenderInBands(ImageOutput::PPMWriter{ oImagePath.toStdString(), height, width });
+        else {
+            auto RenderedImage = RayTracer::Render(renderHeight, renderWidth, SupersamplingExponent, metaData);
+            if (renderHeight != height || renderWidth != width)
+                RenderedImage = Resample(RenderedImage, height, width);
+            success = SaveFrame(oImagePath, RenderedImage);
+
+            for (auto extraSize : settings.value("IO/extra-sizes").toStringList()) {
+                if (extraSize = extraSize.trimmed(); extraSize.isEmpty())
+                    continue;
+                auto extraDimensions = extraSize.split('x');
+                if (extraDimensions.size() != 2 || extraDimensions[0].toInt() <= 0 || extraDimensions[1].toInt() <= 0) {
+                    std::cerr << "Error: malformed entry in IO/extra-sizes: " << extraSize.toStdString() << std::endl;
+                    continue;
+                }
+                auto outputInfo = QFileInfo(oImagePath);
+                auto extraPath = outputInfo.path() + "/" + outputInfo.completeBaseName() + "_" + extraSize + "." + outputInfo.suffix();
+                if (SaveFrame(extraPath, Resample(RenderedImage, extraDimensions[1].toInt(), extraDimensions[0].toInt())))
+                    std::cout << "Save resized copy to " << extraPath.toStdString() << std::endl;
+                else
+                    std::cerr << "Error: failed to save image to " << extraPath.toStdString() << std::endl;
+            }
+        }
+    };
+
     try {
-        RayTracer::Draw(PlaneView<decltype(data)>{ .Data = data, .RowSize = width }, RayTracer::Render(height, width, SupersamplingExponent, metaData));
+        if (isCompiledScene)
+            RenderScene(compiledScene);
+        else
+            RenderScene(metaData);
     }
     catch (std::exception& Error) {
         std::cerr << Error.what() << std::endl;
-    }
-
-    success = image.save(oImagePath);
-    if (!success) {
-        image.save(oImagePath, "PNG");
+        success = false;
     }
 
     if (success) {
@@ -1,6 +1,14 @@
 ﻿#pragma once
 #include "../Ray.hxx"
 #include "../Filter.hxx"
+#include "../Sampling.hxx"
+#include "../Denoiser.hxx"
+#include "../Half.hxx"
+#include "../Resampler.hxx"
+#include "../Mesh.hxx"
+#include "../Texture.hxx"
+#include "../utils/CompiledMesh.h"
+#include "../utils/TextureImage.h"
 #include "glm/gtx/norm.hpp"
 
 namespace RayTracer::Config {
@@ -12,28 +20,327 @@ namespace RayTracer::Config {
     inline auto enableSuperSample = false;
     inline auto enableAcceleration = false;
     inline auto enableDepthOfField = false;
+    inline auto enableSampleAccumulation = false;
+    inline auto enableAdaptiveSampling = false;
+    inline auto AdaptiveSamplingThreshold = 0.05;
+    inline auto SamplesPerPixel = 0_z;
+    inline auto SamplePattern = "stratified"s;
+    inline auto enableDecoupledShading = false;
+    inline auto QualityMap = Filter::Frame<const float>{};
+    inline auto enableQualityMapDepth = false;
+    inline auto MaximumLensSampleCount = 64_z;
+    inline auto enableDenoising = false;
+    inline auto DenoisingIterations = 5;
+    inline auto enableSRGBEncoding = false;
+    inline auto enableDithering = false;
+    inline auto enableHalfPrecisionSupersampling = false;
+    inline auto ResamplingFilter = "bilinear"s;
+    inline auto SceneDirectory = ""s;
 }
 
 namespace RayTracer {
+    auto WithExecutionPolicy(auto&& Function) {
+        if (Config::enableParallelism)
+            return Function(std::execution::par);
+        else
+            return Function(std::execution::seq);
+    }
+    auto WithResamplingKernel(auto&& Function) {
+        if (Config::ResamplingFilter == "lanczos3")
+            return Function(Filter::ResamplingKernels::Lanczos3);
+        else if (Config::ResamplingFilter == "mitchell")
+            return Function(Filter::ResamplingKernels::Mitchell);
+        else if (Config::ResamplingFilter == "catmull-rom")
+            return Function(Filter::ResamplingKernels::CatmullRom);
+        else if (Config::ResamplingFilter == "bilinear")
+            return Function(Filter::ResamplingKernels::Triangle);
+        else
+            throw std::runtime_error{ "Unrecognized resampling filter " + Config::ResamplingFilter + "!" };
+    }
+    inline auto SRGBEncodingTable = [] {
+        auto Table = std::array<float, 4096>{};
+        for (auto x : Range{ std::ssize(Table) })
+            if (auto LinearIntensity = x / (Table.size() - 1.); LinearIntensity <= 0.0031308)
+                Table[x] = 255 * 12.92 * LinearIntensity;
+            else
+                Table[x] = 255 * (1.055 * std::pow(LinearIntensity, 1 / 2.4) - 0.055);
+        return Table;
+    }();
+    auto QuantizeRow(auto&& SourceRows, auto Destination, std::ptrdiff_t Width, auto&& DitherThresholds) {
+        // indexed loops over raw rows: the bodies are branch-free min/max chains so they vectorize
+        using PixelType = std::decay_t<decltype(SourceRows[0][0])>;
+        if (Config::enableSRGBEncoding)
+            for (auto x = 0_z; x < Width; ++x)
+                for (auto c = 0_z; c < 3; ++c) {
+                    auto Index = static_cast<std::ptrdiff_t>(Arithmetic::Min(Arithmetic::Max(SourceRows[c][x], PixelType{ 0 }), PixelType{ 1 }) * (SRGBEncodingTable.size() - 1) + PixelType{ 0.5 });
+                    Destination[4 * x + c] = static_cast<std::uint8_t>(Arithmetic::Min(SRGBEncodingTable[Index] + DitherThresholds[x % 4], PixelType{ 255 }));
+                }
+        else
+            for (auto x = 0_z; x < Width; ++x)
+                for (auto c = 0_z; c < 3; ++c)
+                    Destination[4 * x + c] = static_cast<std::uint8_t>(Arithmetic::Min(Arithmetic::Max(255 * SourceRows[c][x] + DitherThresholds[x % 4], PixelType{ 0 }), PixelType{ 255 }));
+        for (auto x = 0_z; x < Width; ++x)
+            Destination[4 * x + 3] = 255;
+    }
     auto Draw(auto Canvas, auto&& RenderedImage) {
-        auto FloatingPointToUInt8 = [](auto x) { return std::clamp(static_cast<int>(255 * x), 0, 255); };
-        for (auto y : Range{ RenderedImage[0].Height })
-            for (auto x : Range{ RenderedImage[0].Width })
-                Canvas[y][x] = { FloatingPointToUInt8(RenderedImage[0][y][x]), FloatingPointToUInt8(RenderedImage[1][y][x]), FloatingPointToUInt8(RenderedImage[2][y][x]) };
+        using PixelType = std::decay_t<decltype(RenderedImage[0][0][0])>;
+        constexpr auto BayerMatrix = std::array{ std::array{ 0., 8., 2., 10. }, std::array{ 12., 4., 14., 6. }, std::array{ 3., 11., 1., 9. }, std::array{ 15., 7., 13., 5. } };
+        auto Rows = std::vector<std::ptrdiff_t>(RenderedImage[0].Height);
+        std::iota(Rows.begin(), Rows.end(), 0_z);
+        WithExecutionPolicy([&](auto&& ExecutionPolicy) {
+            std::for_each(ExecutionPolicy, Rows.begin(), Rows.end(), [&](auto y) {
+                auto DitherThresholds = std::array<PixelType, 4>{};
+                if (Config::enableDithering)
+                    for (auto x : Range{ 4 })
+                        DitherThresholds[x] = static_cast<PixelType>((BayerMatrix[y % 4][x] + 0.5) / 16);
+                auto SourceRows = std::array{ RenderedImage[0].DirectAccess()[y], RenderedImage[1].DirectAccess()[y], RenderedImage[2].DirectAccess()[y] };
+                QuantizeRow(SourceRows, reinterpret_cast<std::uint8_t*>(Canvas[y]), RenderedImage[0].Width, DitherThresholds);
+            });
+        });
     }
+    template<typename PixelType = float>
     auto BilinearDownsample(auto&& Image) {
-        auto DownsampledImage = Filter::Frame{ Image[0].Height / 2, Image[0].Width / 2, Image.PlaneCount };
+        auto DownsampledImage = Filter::Frame<PixelType>{ Image[0].Height / 2, Image[0].Width / 2, Image.PlaneCount };
         auto HorizontalKernel = [](auto Center) { return 0.25 * Center[0][-1] + 0.5 * Center[0][0] + 0.25 * Center[0][1]; };
         auto VerticalKernel = [](auto Center) { return 0.25 * Center[-1][0] + 0.5 * Center[0][0] + 0.25 * Center[1][0]; };
-        for (auto ResampledImage = VerticalKernel * (HorizontalKernel * Image); auto y : Range{ DownsampledImage[0].Height })
+        auto ResampledImage = WithExecutionPolicy([&](auto&& ExecutionPolicy) {
+            return (VerticalKernel * (HorizontalKernel * Image)).template Evaluate<PixelType>(ExecutionPolicy);
+        });
+        for (auto y : Range{ DownsampledImage[0].Height })
             for (auto x : Range{ DownsampledImage[0].Width })
                 for (auto c : Range{ DownsampledImage.PlaneCount })
                     DownsampledImage[c][y][x] = (ResampledImage[c][2 * y][2 * x] + ResampledImage[c][2 * y + 1][2 * x] + ResampledImage[c][2 * y][2 * x + 1] + ResampledImage[c][2 * y + 1][2 * x + 1]) / 4;
         return DownsampledImage.Finalize();
     }
-    [[gnu::flatten]] auto Render(auto Height, auto Width, auto SupersamplingExponent, auto&& Metadata) {
+    // which output pixels each supersampled column (or row) contributes to and by how much: the taps of the configured
+    // resampling filter, or the footprint of the repeated bilinear pyramid, so accumulation matches the resolved image
+    auto ReconstructionWeights(auto Length, auto SupersamplingExponent) {
+        using ContributionType = std::tuple<std::ptrdiff_t, double>;
+        auto SupersampledLength = static_cast<std::ptrdiff_t>(Length) << SupersamplingExponent;
+        if (Config::ResamplingFilter != "bilinear" && SupersamplingExponent > 0) {
+            auto Weights = WithResamplingKernel([&](auto&& Kernel) { return Filter::ResamplingWeightTable{ SupersampledLength, static_cast<std::ptrdiff_t>(Length), Kernel }; });
+            auto Contributions = std::vector<std::vector<ContributionType>>(SupersampledLength);
+            for (auto x : Range{ Length })
+                for (auto Tap : Range{ Weights.TapCount })
+                    Contributions[Weights.Startpoints[x] + Tap].push_back({ x, Weights.Weights[x * Weights.TapCount + Tap] });
+            return Contributions;
+        }
+        auto Footprints = std::vector<std::vector<ContributionType>>{};
+        for (auto x : Range{ SupersampledLength })
+            Footprints.push_back({ { x, 1. } });
+        for (auto _ : Range{ SupersamplingExponent }) {
+            auto DownsampledFootprints = std::vector<std::vector<ContributionType>>{};
+            for (auto Bound = static_cast<std::ptrdiff_t>(Footprints.size()); auto x : Range{ Bound / 2 }) {
+                auto CombinedWeights = std::unordered_map<std::ptrdiff_t, double>{};
+                for (auto [Offset, TapWeight] : std::array{ std::tuple{ 2 * x - 1, 0.125 }, std::tuple{ 2 * x, 0.375 }, std::tuple{ 2 * x + 1, 0.375 }, std::tuple{ 2 * x + 2, 0.125 } })
+                    for (auto [SampleIndex, Weight] : Footprints[RemappingFunctions::Reflect(Offset, Bound)])
+                        CombinedWeights[SampleIndex] += TapWeight * Weight;
+                DownsampledFootprints.push_back({ CombinedWeights.begin(), CombinedWeights.end() });
+            }
+            Footprints = std::move(DownsampledFootprints);
+        }
+        auto Contributions = std::vector<std::vector<ContributionType>>(SupersampledLength);
+        for (auto x : Range{ Length })
+            for (auto [SampleIndex, Weight] : Footprints[x])
+                Contributions[SampleIndex].push_back({ x, Weight });
+        return Contributions;
+    }
+    // whether pixels are sampled by a pattern (and a lens) rather than traced on a regular supersampled grid
+    inline auto UsesSamplePattern() {
+        return (Config::enableSuperSample && (Config::SamplesPerPixel > 0 || Config::QualityMap.PlaneCount != 0)) || Config::enableDepthOfField;
+    }
+    auto TracedSupersamplingExponent(auto SupersamplingExponent) {
+        return Config::enableSuperSample && UsesSamplePattern() == false ? SupersamplingExponent : 0;
+    }
+
+    // the lights, materials and objects of a scene, built once and shared by every band rendered from it. objects refer
+    // to the materials they are given, so the records are neither copied nor moved.
+    struct SceneRecords {
+        using MaterialType = struct {
+            glm::vec3 AmbientCoefficients;
+            glm::vec3 DiffuseCoefficients;
+            glm::vec3 SpecularCoefficients;
+            glm::vec3 ReflectionCoefficients;
+            glm::vec3 TransparencyCoefficients;
+            double SpecularExponent;
+            double η;
+            bool IsReflective;
+            bool IsTransparent;
+            std::function<glm::vec3(const glm::vec3&, const glm::vec3&, double)> DiffuseTexture;
+        };
+        field(LightRecords, std::vector<Lights::Ǝ>{});
+        field(MaterialRecords, std::vector<MaterialType>{});
+        field(TexturedMaterialRecords, std::list<MaterialType>{});
+        field(ObstructionRecords, std::vector<ImplicitFunctions::Obstruction>{});
+        field(ObjectRecords, std::vector<std::tuple<ImplicitFunctions::Ǝ, const MaterialType&>>{});
+
+    public:
+        SceneRecords(const SceneRecords&) = delete;
+        SceneRecords(auto Height, auto SupersamplingExponent, auto&& Metadata) {
+            LightRecords = Metadata.lights | [](auto&& x)->Lights::Ǝ {
+                auto QuadraticAttenuation = [](auto&& Coefficients) {
+                    return [=](auto&& Distance) {
+                        return std::min(1 / (Coefficients[0] + Coefficients[1] * Distance + Coefficients[2] * Distance * Distance), 1.f);
+                    };
+                };
+                if (x.type == LightType::LIGHT_POINT)
+                    return Lights::Point(glm::vec3{ x.pos }, glm::vec3{ x.color }, QuadraticAttenuation(x.function));
+                else if (x.type == LightType::LIGHT_DIRECTIONAL)
+                    return Lights::Directional(glm::normalize(glm::vec3{ x.dir }), glm::vec3{ x.color });
+                else if (x.type == LightType::LIGHT_SPOT)
+                    return Lights::Spot(glm::vec3{ x.pos }, glm::normalize(glm::vec3{ x.dir }), glm::radians(x.angle), glm::radians(x.penumbra), glm::vec3{ x.color }, QuadraticAttenuation(x.function));
+                else
+                    throw std::runtime_error{ "Unrecognized light type detected!" };
+            };
+
+            MaterialRecords = Metadata.materials | [](auto&& x) {
+                return MaterialType{
+                    .AmbientCoefficients = glm::vec3{ x.cAmbient },
+                    .DiffuseCoefficients = glm::vec3{ x.cDiffuse },
+                    .SpecularCoefficients = glm::vec3{ x.cSpecular },
+                    .ReflectionCoefficients = glm::vec3{ x.cReflective },
+                    .TransparencyCoefficients = glm::vec3{ x.cTransparent },
+                    .SpecularExponent = x.shininess,
+                    .η = x.ior,
+                    .IsReflective = Config::enableReflection && glm::l1Norm(glm::vec3{ x.cReflective }) > 1e-16,
+                    .IsTransparent = Config::enableRefraction && glm::l1Norm(glm::vec3{ x.cTransparent }) > 1e-16
+                };
+            };
+
+            // relative mesh paths are resolved like texture paths below, so the cache sees one key per file
+            auto Meshfile = [&](auto&& x) {
+                auto Path = [&] {
+                    if constexpr (requires { x.meshfileOffset; })
+                        return std::filesystem::path{ Metadata.string(x.meshfileOffset, x.meshfileLength) };
+                    else
+                        return std::filesystem::path{ Metadata.meshfiles[x.meshfileIndex] };
+                }();
+                return (Path.is_relative() ? std::filesystem::path{ Config::SceneDirectory } / Path : Path).string();
+            };
+            // compiled meshes are mapped in place and decoded leaf by leaf as rays reach them, anything else is parsed as OBJ
+            auto LoadMeshfile = [](auto&& Path)->Meshes::Geometry {
+                if (CompiledMesh::isCompiledMesh(Path) == false)
+                    return Meshes::Load(Path);
+                auto Mapping = std::make_shared<CompiledMesh>();
+                if (Mapping->load(Path) == false)
+                    throw std::runtime_error{ "Failed to map compiled mesh " + Path + "!" };
+                auto Mesh = Meshes::QuantizedMesh{};
+                Mesh.Nodes = Mapping->nodes;
+                Mesh.Leaves = Mapping->leaves;
+                Mesh.LatticeOrigin = Mapping->latticeOrigin;
+                Mesh.LatticeStep = Mapping->latticeStep;
+                Mesh.TriangleCount = Mapping->triangleCount;
+                Mesh.Storage = Mapping;
+                return std::make_shared<const Meshes::QuantizedMesh>(std::move(Mesh));
+            };
+            // relative texture paths are taken relative to the scene file, not to wherever the renderer was started
+            auto Texturefile = [&](auto&& x) {
+                auto Path = [&] {
+                    if constexpr (requires { x.filenameOffset; })
+                        return std::filesystem::path{ Metadata.string(x.filenameOffset, x.filenameLength) };
+                    else
+                        return std::filesystem::path{ x.filename };
+                }();
+                return (Path.is_relative() ? std::filesystem::path{ Config::SceneDirectory } / Path : Path).string();
+            };
+            // an image that fails to load is reported once (by the loader) and leaves its materials untextured
+            auto LoadTexture = [](auto&& Path) {
+                if (auto Image = TextureImage{}; Image.load(Path))
+                    return std::make_shared<const Textures::MipMappedTexture>(Image.height, Image.width, Image.pixels);
+                return std::shared_ptr<const Textures::MipMappedTexture>{};
+            };
+            // the angle a (sub)pixel subtends, which scales with distance into the width of the surface patch a ray stands for
+            auto PixelSpread = 2 * std::tan(static_cast<double>(glm::radians(Metadata.cameraData.heightAngle)) / 2) / (static_cast<std::ptrdiff_t>(Height) << TracedSupersamplingExponent(SupersamplingExponent));
+            ObjectRecords = Metadata.shapes | [&](auto&& x) {
+                auto [InverseTransformation, NormalTransformation] = [&] {
+                    if constexpr (requires { x.inverseCtm; })
+                        return std::tuple{ x.inverseCtm, x.normalMatrix };
+                    else
+                        return std::tuple{ glm::inverse(x.ctm), glm::inverse(glm::transpose(glm::mat3{ x.ctm })) };
+                }();
+                auto InstantiateWithOcclusion = [&](auto&& StandardImplicitFunction, auto&& StandardOcclusion) {
+                    if (Config::enableShadow)
+                        ObstructionRecords.push_back(ImplicitFunctions::TransformOcclusion(InverseTransformation, StandardOcclusion));
+                    return ImplicitFunctions::Transform(InverseTransformation, NormalTransformation, StandardImplicitFunction);
+                };
+                auto Instantiate = [&](auto&& StandardImplicitFunction) {
+                    return InstantiateWithOcclusion(StandardImplicitFunction, ImplicitFunctions::Occlusion(StandardImplicitFunction));
+                };
+                auto ImplicitFunction = [&]()->ImplicitFunctions::Ǝ {
+                    if (x.type == PrimitiveType::PRIMITIVE_CUBE)
+                        return Instantiate(ImplicitFunctions::Standard::Cube);
+                    else if (x.type == PrimitiveType::PRIMITIVE_SPHERE)
+                        return Instantiate(ImplicitFunctions::Standard::Sphere);
+                    else if (x.type == PrimitiveType::PRIMITIVE_CYLINDER)
+                        return Instantiate(ImplicitFunctions::Standard::Cylinder);
+                    else if (x.type == PrimitiveType::PRIMITIVE_CONE)
+                        return Instantiate(ImplicitFunctions::Standard::Cone);
+                    else if (x.type == PrimitiveType::PRIMITIVE_TORUS)
+                        return Instantiate(ImplicitFunctions::Standard::Torus);
+                    else if (x.type == PrimitiveType::PRIMITIVE_MESH)
+                        return std::visit([&](auto&& Mesh)->ImplicitFunctions::Ǝ {
+                            return InstantiateWithOcclusion(ImplicitFunctions::Standard::Mesh(Mesh), ImplicitFunctions::Standard::MeshOcclusion(Mesh));
+                        }, Meshes::Cache(Meshfile(x), LoadMeshfile));
+                    else
+                        throw std::runtime_error{ "Unrecognized primitive type detected!" };
+                }();
+                // textured shapes get a material of their own, since the lookup depends on their transformation and mapping
+                auto Texturize = [&](auto&& Mapping)->const MaterialType& {
+                    auto&& SceneMaterial = Metadata.materials[x.materialIndex];
+                    auto Texture = Textures::Cache(Texturefile(SceneMaterial.textureMap), LoadTexture);
+                    if (Texture == nullptr)
+                        return MaterialRecords[x.materialIndex];
+                    auto& Material = TexturedMaterialRecords.emplace_back(MaterialRecords[x.materialIndex]);
+                    auto [Repetitions, Blend] = std::tuple{ glm::dvec2{ SceneMaterial.textureMap.repeatU, SceneMaterial.textureMap.repeatV }, SceneMaterial.blend };
+                    Material.DiffuseTexture = [=, DiffuseCoefficients = Material.DiffuseCoefficients](auto&& SurfacePosition, auto&& SurfaceNormal, auto Distance) {
+                        auto MapToTexture = [&](auto&& Position) {
+                            return Mapping(glm::vec3{ InverseTransformation * glm::vec4{ Position, 1 } }) * Repetitions;
+                        };
+                        auto TextureCoordinates = MapToTexture(SurfacePosition);
+                        auto Footprint = [&, Extent = static_cast<float>(Distance * PixelSpread)](auto&& Direction) {
+                            auto Difference = MapToTexture(SurfacePosition + Extent * Direction) - TextureCoordinates;
+                            Difference -= glm::round(Difference);
+                            return glm::length(Difference * glm::dvec2{ Texture->Levels[0].Width, Texture->Levels[0].Height });
+                        };
+                        auto Tangent = glm::normalize(glm::cross(SurfaceNormal, std::abs(SurfaceNormal.x) < 0.9f ? glm::vec3{ 1, 0, 0 } : glm::vec3{ 0, 1, 0 }));
+                        auto Texel = Texture->Sample(TextureCoordinates.x, TextureCoordinates.y, Arithmetic::Max(Footprint(Tangent), Footprint(glm::cross(SurfaceNormal, Tangent))));
+                        return glm::mix(DiffuseCoefficients, Texel, Blend);
+                    };
+                    return Material;
+                };
+                auto& Material = [&]()->const MaterialType& {
+                    if (auto&& SceneMaterial = Metadata.materials[x.materialIndex]; Config::enableTextureMap == false || SceneMaterial.textureMap.isUsed == false || SceneMaterial.blend <= 0)
+                        return MaterialRecords[x.materialIndex];
+                    else if (x.type == PrimitiveType::PRIMITIVE_CUBE)
+                        return Texturize(Textures::Mappings::Cube);
+                    else if (x.type == PrimitiveType::PRIMITIVE_SPHERE)
+                        return Texturize(Textures::Mappings::Sphere);
+                    else if (x.type == PrimitiveType::PRIMITIVE_CYLINDER)
+                        return Texturize(Textures::Mappings::Cylinder);
+                    else if (x.type == PrimitiveType::PRIMITIVE_CONE)
+                        return Texturize(Textures::Mappings::Cone);
+                    else if (x.type == PrimitiveType::PRIMITIVE_TORUS)
+                        return Texturize(Textures::Mappings::Torus);
+                    else
+                        return MaterialRecords[x.materialIndex];
+                }();
+                return std::tuple<ImplicitFunctions::Ǝ, const MaterialType&>{ ImplicitFunction, Material };
+            };
+        }
+    };
+    template<typename PixelType = float>
+    [[gnu::flatten]] auto Render(auto Height, auto Width, auto SupersamplingExponent, auto&& Metadata, const SceneRecords& Scene, std::ptrdiff_t BandStartpoint, std::ptrdiff_t BandHeight) {
         SupersamplingExponent = Config::enableSuperSample ? SupersamplingExponent : 0;
-        Height <<= SupersamplingExponent;
+        auto QualityMapEnabled = Config::QualityMap.PlaneCount != 0;
+        auto SamplePatternEnabled = UsesSamplePattern();
+        auto FullQualitySampleCount = Config::enableSuperSample && Config::SamplesPerPixel > 0 ? Config::SamplesPerPixel : 1_z << 2 * SupersamplingExponent;
+        SupersamplingExponent = TracedSupersamplingExponent(SupersamplingExponent);
+        auto FullHeight = static_cast<std::ptrdiff_t>(Height);
+        // 4 rows cover the 3-pixel reach of Lanczos3 when a band is resampled, on top of the denoiser's footprint
+        auto BandHalo = 4 + (Config::enableDenoising ? 2 * ((1_z << Config::DenoisingIterations) - 1) : 0);
+        auto [HaloedBandStartpoint, HaloedBandEndpoint] = std::array{ Arithmetic::Max(BandStartpoint - BandHalo, 0_z), Arithmetic::Min(BandStartpoint + BandHeight + BandHalo, FullHeight) };
+        auto [OutputHeight, OutputWidth] = std::tuple{ HaloedBandEndpoint - HaloedBandStartpoint, Width };
+        Height = OutputHeight << SupersamplingExponent;
         Width <<= SupersamplingExponent;
 
         using CameraType = struct {
@@ -42,89 +349,309 @@ namespace RayTracer {
             glm::vec3 Up;
             double HeightAngle;
             double FocalLength;
+            double Aperture;
         };
         auto Camera = CameraType{
             .Position = glm::vec3{ Metadata.cameraData.pos },
             .Look = glm::normalize(glm::vec3{ Metadata.cameraData.look }),
             .Up = glm::normalize(glm::vec3{ Metadata.cameraData.up }),
             .HeightAngle = glm::radians(Metadata.cameraData.heightAngle),
-            .FocalLength = 0.1
+            .FocalLength = Config::enableDepthOfField ? Metadata.cameraData.focalLength : 0.1,
+            .Aperture = Config::enableDepthOfField ? Metadata.cameraData.aperture : 0.
+        };
+        auto ProjectToWorldSpace = [ProjectFullFrameToWorldSpace = ViewPlane::ConfigureProjectorFromScreenSpaceToWorldSpace(Camera, Width, FullHeight << SupersamplingExponent), yOffset = HaloedBandStartpoint << SupersamplingExponent](auto x, auto y) {
+            return ProjectFullFrameToWorldSpace(x, y + yOffset);
         };
-        auto ProjectToWorldSpace = ViewPlane::ConfigureProjectorFromScreenSpaceToWorldSpace(Camera, Width, Height);
+        auto ProjectFromAperture = ViewPlane::ConfigureProjectorFromApertureToWorldSpace(Camera);
 
-        auto LightRecords = Metadata.lights | [](auto&& x)->Lights::Ǝ {
-            auto QuadraticAttenuation = [](auto&& Coefficients) {
-                return [=](auto&& Distance) {
-                    return std::min(1 / (Coefficients[0] + Coefficients[1] * Distance + Coefficients[2] * Distance * Distance), 1.f);
-                };
-            };
-            if (x.type == LightType::LIGHT_POINT)
-                return Lights::Point(glm::vec3{ x.pos }, glm::vec3{ x.color }, QuadraticAttenuation(x.function));
-            else if (x.type == LightType::LIGHT_DIRECTIONAL)
-                return Lights::Directional(glm::normalize(glm::vec3{ x.dir }), glm::vec3{ x.color });
-            else if (x.type == LightType::LIGHT_SPOT)
-                return Lights::Spot(glm::vec3{ x.pos }, glm::normalize(glm::vec3{ x.dir }), glm::radians(x.angle), glm::radians(x.penumbra), glm::vec3{ x.color }, QuadraticAttenuation(x.function));
+        auto& ObjectRecords = Scene.ObjectRecords;
+        auto IlluminationModel = Illuminations::WhittedModel(Scene.LightRecords, Scene.ObstructionRecords);
+        auto GeneratePrimaryRay = [&](auto x, auto y, auto LensU, auto LensV) {
+            auto EyePoint = Config::enableDepthOfField ? ProjectFromAperture(LensU, LensV) : Camera.Position;
+            return std::tuple{ EyePoint, glm::normalize(ProjectToWorldSpace(x, y) - EyePoint) };
+        };
+        auto TracePrimaryRay = [&](auto x, auto y, auto InitialRecursionDepth, double LensU = 0.5, double LensV = 0.5) {
+            auto [EyePoint, RayDirection] = GeneratePrimaryRay(x, y, LensU, LensV);
+            return Ray::Trace(EyePoint, RayDirection, IlluminationModel, ObjectRecords, InitialRecursionDepth);
+        };
+
+        auto PixelCenter = [&](auto y, auto x) {
+            auto [SubsampleCount, CenterOffset] = std::tuple{ 1_z << SupersamplingExponent, ((1_z << SupersamplingExponent) - 1) / 2. };
+            return std::array{ x * SubsampleCount + CenterOffset, y * SubsampleCount + CenterOffset };
+        };
+
+        // what the centre pinhole ray of every pixel hits; its depth places the circle of confusion, and without depth of field
+        // the whole record guides the denoiser. frames nothing reads stay empty.
+        auto [PrimaryHitDepths, PrimaryHitNormals, PrimaryHitObjectIndices] = [&] {
+            auto [DepthsRequired, GuidesRequired] = std::array{ Config::enableDepthOfField || Config::enableDenoising, Config::enableDenoising && Config::enableDepthOfField == false };
+            auto Depths = DepthsRequired ? Filter::Frame{ OutputHeight, OutputWidth, 1 } : Filter::Frame{};
+            auto Normals = GuidesRequired ? Filter::Frame{ OutputHeight, OutputWidth, 3 } : Filter::Frame{};
+            auto ObjectIndices = GuidesRequired ? Filter::Frame<std::ptrdiff_t>{ OutputHeight, OutputWidth, 1 } : Filter::Frame<std::ptrdiff_t>{};
+            if (DepthsRequired)
+                for (auto y : Range{ OutputHeight })
+                    for (auto x : Range{ OutputWidth }) {
+                        auto [xCenter, yCenter] = PixelCenter(y, x);
+                        auto RayDirection = glm::normalize(ProjectToWorldSpace(xCenter, yCenter) - Camera.Position);
+                        auto [t, SurfaceNormal, _, ObjectIndex] = Ray::Intersect(Camera.Position, RayDirection, ObjectRecords);
+                        Depths[0][y][x] = t != Ray::NoIntersection ? t * glm::dot(RayDirection, Camera.Look) : 0.;
+                        if (GuidesRequired) {
+                            for (auto c : Range{ 3 })
+                                Normals[c][y][x] = SurfaceNormal[c];
+                            ObjectIndices[0][y][x] = ObjectIndex;
+                        }
+                    }
+            return std::tuple{ Depths.Finalize(), Normals.Finalize(), ObjectIndices.Finalize() };
+        }();
+        // without depth of field nothing is defocused, so the frame stays empty and every pixel reads 0
+        auto CircleOfConfusion = [&] {
+            if (Config::enableDepthOfField == false)
+                return Filter::Frame<const float>{};
+            auto EstimatedCircleOfConfusion = Filter::Frame{ OutputHeight, OutputWidth, 1 };
+            for (auto PixelsPerUnitLength = FullHeight / (2 * Camera.FocalLength * std::tan(Camera.HeightAngle / 2)); auto y : Range{ OutputHeight })
+                for (auto x : Range{ OutputWidth })
+                    if (auto Depth = PrimaryHitDepths[0][y][x]; Depth > 0)
+                        EstimatedCircleOfConfusion[0][y][x] = Camera.Aperture * std::abs(1 - Camera.FocalLength / Depth) * PixelsPerUnitLength;
+                    else
+                        EstimatedCircleOfConfusion[0][y][x] = Camera.Aperture * PixelsPerUnitLength;
+            auto HorizontalDilation = [](auto Center) { return std::max({ Center[0][-2], Center[0][-1], Center[0][0], Center[0][1], Center[0][2] }); };
+            auto VerticalDilation = [](auto Center) { return std::max({ Center[-2][0], Center[-1][0], Center[0][0], Center[1][0], Center[2][0] }); };
+            return (VerticalDilation * (HorizontalDilation * EstimatedCircleOfConfusion.Finalize())).Evaluate();
+        }();
+        auto PixelCircleOfConfusion = [&](auto y, auto x) {
+            return Config::enableDepthOfField ? CircleOfConfusion[0][y][x] : 0.f;
+        };
+        auto PixelSampleCount = [&](auto y, auto x) {
+            auto SampleCount = FullQualitySampleCount;
+            if (QualityMapEnabled)
+                SampleCount = Arithmetic::Max(static_cast<std::ptrdiff_t>(std::round(Config::QualityMap[0][y + HaloedBandStartpoint][x] * FullQualitySampleCount)), 1_z);
+            if (Config::enableDepthOfField)
+                SampleCount = Arithmetic::Max(SampleCount, std::clamp(static_cast<std::ptrdiff_t>(std::ceil(PixelCircleOfConfusion(y, x) * PixelCircleOfConfusion(y, x))), 1_z, Config::MaximumLensSampleCount));
+            return SampleCount;
+        };
+        auto PixelRecursionDepth = [&](auto y, auto x) {
+            if (QualityMapEnabled && Config::enableQualityMapDepth)
+                return Ray::RecursiveTracingDepth - Arithmetic::Max(static_cast<int>(std::round(Config::QualityMap[0][y + HaloedBandStartpoint][x] * (Ray::RecursiveTracingDepth - 1))), 1);
+            return 1;
+        };
+        auto SamplePosition = Config::SamplePattern == "r2" ? +Sampling::Patterns::R2 : +Sampling::Patterns::Stratified;
+        auto PixelSamplePositions = [&](auto y, auto x) {
+            auto SamplePositions = std::vector<std::array<double, 5>>{};
+            if (SamplePatternEnabled)
+                for (auto SampleCount = PixelSampleCount(y, x); auto Index : Range{ SampleCount }) {
+                    auto [u, v, Weight] = SamplePosition(Index, SampleCount);
+                    auto [LensU, LensV, _] = Sampling::Patterns::Aperture(Index, SampleCount);
+                    SamplePositions.push_back({ x + Sampling::ReconstructionFilters::QuadraticBSpline(u), y + Sampling::ReconstructionFilters::QuadraticBSpline(v), Weight, LensU, LensV });
+                }
             else
-                throw std::runtime_error{ "Unrecognized light type detected!" };
+                for (auto SubsampleCount = 1_z << SupersamplingExponent; auto yOffset : Range{ SubsampleCount })
+                    for (auto xOffset : Range{ SubsampleCount })
+                        SamplePositions.push_back({ x * SubsampleCount + xOffset + 0., y * SubsampleCount + yOffset + 0., 1. / (SubsampleCount * SubsampleCount), 0.5, 0.5 });
+            return SamplePositions;
+        };
+        // with depth of field the centre pinhole ray sees only the in-focus surface, and guides taken from it would stop
+        // the denoiser at edges that are actually blurred. the pixels record their lens samples' hits instead as they are
+        // traced: the object carrying most of a pixel's sample weight, with its weighted mean depth and normal.
+        using GuideGroupType = struct {
+            std::ptrdiff_t ObjectIndex;
+            double Weight;
+            double WeightedDepth;
+            glm::vec3 WeightedNormal;
+        };
+        auto GuidesFromLensSamples = Config::enableDepthOfField && Config::enableDenoising;
+        auto LensGuideDepths = GuidesFromLensSamples ? Filter::Frame{ OutputHeight, OutputWidth, 1 } : Filter::Frame{};
+        auto LensGuideNormals = GuidesFromLensSamples ? Filter::Frame{ OutputHeight, OutputWidth, 3 } : Filter::Frame{};
+        auto LensGuideObjectIndices = GuidesFromLensSamples ? Filter::Frame<std::ptrdiff_t>{ OutputHeight, OutputWidth, 1 } : Filter::Frame<std::ptrdiff_t>{};
+        auto AddGuideSample = [&](auto& GuideGroups, auto&& EyePoint, auto&& RayDirection, auto&& IntersectionRecord, double Weight) {
+            auto&& [t, SurfaceNormal, _, ObjectIndex] = IntersectionRecord;
+            auto Depth = t != Ray::NoIntersection ? glm::dot(EyePoint - Camera.Position, Camera.Look) + t * glm::dot(RayDirection, Camera.Look) : 0.;
+            if (auto Group = std::find_if(GuideGroups.begin(), GuideGroups.end(), [&](auto& x) { return x.ObjectIndex == ObjectIndex; }); Group == GuideGroups.end())
+                GuideGroups.push_back({ .ObjectIndex = ObjectIndex, .Weight = Weight, .WeightedDepth = Weight * Depth, .WeightedNormal = static_cast<float>(Weight) * SurfaceNormal });
+            else {
+                Group->Weight += Weight;
+                Group->WeightedDepth += Weight * Depth;
+                Group->WeightedNormal += static_cast<float>(Weight) * SurfaceNormal;
+            }
         };
+        auto StoreGuide = [&](auto y, auto x, auto& GuideGroups) {
+            auto& Majority = *std::max_element(GuideGroups.begin(), GuideGroups.end(), [](auto& x, auto& y) { return x.Weight < y.Weight; });
+            auto Normal = glm::length2(Majority.WeightedNormal) > 0 ? glm::normalize(Majority.WeightedNormal) : glm::vec3{};
+            LensGuideDepths[0][y][x] = Majority.WeightedDepth / Majority.Weight;
+            for (auto c : Range{ 3 })
+                LensGuideNormals[c][y][x] = Normal[c];
+            LensGuideObjectIndices[0][y][x] = Majority.ObjectIndex;
+        };
+        auto SamplePixel = [&](auto y, auto x) {
+            auto [AccumulatedIntensity, InitialRecursionDepth] = std::tuple{ glm::vec3{ 0, 0, 0 }, PixelRecursionDepth(y, x) };
+            // samples through different points of the lens see different sides of an object, so with depth of field
+            // one shading result per object would flatten the defocus blur inside it
+            if (Config::enableDecoupledShading == false || Config::enableDepthOfField) {
+                auto GuideGroups = std::vector<GuideGroupType>{};
+                for (auto [xSample, ySample, Weight, LensU, LensV] : PixelSamplePositions(y, x)) {
+                    auto [EyePoint, RayDirection] = GeneratePrimaryRay(xSample, ySample, LensU, LensV);
+                    auto IntersectionRecord = Ray::Intersect(EyePoint, RayDirection, ObjectRecords);
+                    AccumulatedIntensity += Weight * Ray::Shade(EyePoint, RayDirection, IntersectionRecord, IlluminationModel, ObjectRecords, InitialRecursionDepth);
+                    if (GuidesFromLensSamples)
+                        AddGuideSample(GuideGroups, EyePoint, RayDirection, IntersectionRecord, Weight);
+                }
+                if (GuidesFromLensSamples)
+                    StoreGuide(y, x, GuideGroups);
+                return AccumulatedIntensity;
+            }
 
-        auto ObjectRecords = Metadata.shapes | [](auto&& x) {
-            using MaterialType = struct {
-                glm::vec3 AmbientCoefficients;
-                glm::vec3 DiffuseCoefficients;
-                glm::vec3 SpecularCoefficients;
-                glm::vec3 ReflectionCoefficients;
-                glm::vec3 TransparencyCoefficients;
-                double SpecularExponent;
-                double η;
-                bool IsReflective;
-                bool IsTransparent;
-            };
-            auto&& [Primitive, ObjectTransformation] = x;
-            auto ImplicitFunction = [&]()->ImplicitFunctions::Ǝ {
-                if (Primitive.type == PrimitiveType::PRIMITIVE_CUBE)
-                    return ObjectTransformation * ImplicitFunctions::Standard::Cube;
-                else if (Primitive.type == PrimitiveType::PRIMITIVE_SPHERE)
-                    return ObjectTransformation * ImplicitFunctions::Standard::Sphere;
-                else if (Primitive.type == PrimitiveType::PRIMITIVE_CYLINDER)
-                    return ObjectTransformation * ImplicitFunctions::Standard::Cylinder;
-                else if (Primitive.type == PrimitiveType::PRIMITIVE_CONE)
-                    return ObjectTransformation * ImplicitFunctions::Standard::Cone;
-                else
-                    throw std::runtime_error{ "Unrecognized primitive type detected!" };
-            }();
-            auto Material = MaterialType{
-                .AmbientCoefficients = glm::vec3{ Primitive.material.cAmbient },
-                .DiffuseCoefficients = glm::vec3{ Primitive.material.cDiffuse },
-                .SpecularCoefficients = glm::vec3{ Primitive.material.cSpecular },
-                .ReflectionCoefficients = glm::vec3{ Primitive.material.cReflective },
-                .TransparencyCoefficients = glm::vec3{ Primitive.material.cTransparent },
-                .SpecularExponent = Primitive.material.shininess,
-                .η = Primitive.material.ior,
-                .IsReflective = Config::enableReflection && glm::l1Norm(glm::vec3{ Primitive.material.cReflective }) > 1e-16,
-                .IsTransparent = Config::enableRefraction && glm::l1Norm(glm::vec3{ Primitive.material.cTransparent }) > 1e-16
+            using ShadingGroupType = struct {
+                std::ptrdiff_t ObjectIndex;
+                double Weight;
+                std::ptrdiff_t Representative;
+                double DistanceToCenter;
             };
-            return std::tuple{ ImplicitFunction, Material };
+            using PrimaryHitType = std::tuple<glm::vec3, glm::vec3, decltype(Ray::Intersect(Camera.Position, Camera.Look, ObjectRecords))>;
+            auto [ShadingGroups, PrimaryHits] = std::tuple{ std::vector<ShadingGroupType>{}, std::vector<PrimaryHitType>{} };
+            auto [xCenter, yCenter] = PixelCenter(y, x);
+            for (auto [xSample, ySample, Weight, LensU, LensV] : PixelSamplePositions(y, x)) {
+                auto [EyePoint, RayDirection] = GeneratePrimaryRay(xSample, ySample, LensU, LensV);
+                auto ObjectIndex = std::get<3>(std::get<2>(PrimaryHits.emplace_back(EyePoint, RayDirection, Ray::Intersect(EyePoint, RayDirection, ObjectRecords))));
+                auto [Representative, DistanceToCenter] = std::tuple{ std::ssize(PrimaryHits) - 1, std::hypot(xSample - xCenter, ySample - yCenter) };
+                if (auto Group = std::find_if(ShadingGroups.begin(), ShadingGroups.end(), [&](auto& x) { return x.ObjectIndex == ObjectIndex; }); Group == ShadingGroups.end())
+                    ShadingGroups.push_back({ .ObjectIndex = ObjectIndex, .Weight = Weight, .Representative = Representative, .DistanceToCenter = DistanceToCenter });
+                else {
+                    Group->Weight += Weight;
+                    if (DistanceToCenter < Group->DistanceToCenter)
+                        std::tie(Group->Representative, Group->DistanceToCenter) = std::tuple{ Representative, DistanceToCenter };
+                }
+            }
+            for (auto&& Group : ShadingGroups) {
+                auto& [EyePoint, RayDirection, IntersectionRecord] = PrimaryHits[Group.Representative];
+                AccumulatedIntensity += Group.Weight * Ray::Shade(EyePoint, RayDirection, IntersectionRecord, IlluminationModel, ObjectRecords, InitialRecursionDepth);
+            }
+            return AccumulatedIntensity;
         };
 
-        auto ObstructionRecords = Config::enableShadow ? ObjectRecords | [](auto&& x) { return std::get<0>(x); } : std::vector<ImplicitFunctions::Ǝ>{};
-        auto IlluminationModel = Illuminations::WhittedModel(LightRecords, ObstructionRecords);
-        auto SupersampledImage = Filter::Frame{ Height, Width, 3 };
-
         Illuminations::Ka = Metadata.globalData.ka;
         Illuminations::Kd = Metadata.globalData.kd;
         Illuminations::Ks = Metadata.globalData.ks;
         Illuminations::Kt = Metadata.globalData.kt;
 
-        for (auto y : Range{ Height })
-            for (auto x : Range{ Width })
-                for (auto AccumulatedIntensity = Ray::Trace(Camera.Position, glm::normalize(ProjectToWorldSpace(x, y) - Camera.Position), IlluminationModel, ObjectRecords, 1); auto c : Range{ 3 })
-                    SupersampledImage[c][y][x] = AccumulatedIntensity[c];
+        auto RenderedImage = [&] {
+            if (Config::enableAdaptiveSampling) {
+                auto PreviewImage = Filter::Frame<PixelType>{ OutputHeight, OutputWidth, 3 };
+                auto PreviewObjectIndices = Filter::Frame<std::ptrdiff_t>{ OutputHeight, OutputWidth, 1 };
+                for (auto y : Range{ OutputHeight })
+                    for (auto x : Range{ OutputWidth }) {
+                        auto [xCenter, yCenter] = PixelCenter(y, x);
+                        auto RayDirection = glm::normalize(ProjectToWorldSpace(xCenter, yCenter) - Camera.Position);
+                        auto IntersectionRecord = Ray::Intersect(Camera.Position, RayDirection, ObjectRecords);
+                        for (auto AccumulatedIntensity = Ray::Shade(Camera.Position, RayDirection, IntersectionRecord, IlluminationModel, ObjectRecords, PixelRecursionDepth(y, x)); auto c : Range{ 3 })
+                            PreviewImage[c][y][x] = AccumulatedIntensity[c];
+                        PreviewObjectIndices[0][y][x] = std::get<3>(IntersectionRecord);
+                        if (GuidesFromLensSamples) {
+                            auto GuideGroups = std::vector<GuideGroupType>{};
+                            AddGuideSample(GuideGroups, Camera.Position, RayDirection, IntersectionRecord, 1.);
+                            StoreGuide(y, x, GuideGroups);
+                        }
+                    }
+
+                auto [ReferenceImage, ReferenceObjectIndices] = std::tuple{ PreviewImage.Finalize(), PreviewObjectIndices.Finalize() };
+                auto RequiresRefinement = [&](auto y, auto x) {
+                    for (auto yOffset : Range{ -1, 2 })
+                        for (auto xOffset : Range{ -1, 2 }) {
+                            if (ReferenceObjectIndices[0][y + yOffset][x + xOffset] != ReferenceObjectIndices[0][y][x])
+                                return true;
+                            for (auto c : Range{ 3 })
+                                if (std::abs(std::clamp<double>(ReferenceImage[c][y + yOffset][x + xOffset], 0, 1) - std::clamp<double>(ReferenceImage[c][y][x], 0, 1)) > Config::AdaptiveSamplingThreshold)
+                                    return true;
+                        }
+                    return false;
+                };
+
+                auto AdaptiveImage = Filter::Frame<PixelType>{ OutputHeight, OutputWidth, 3 };
+                for (auto y : Range{ OutputHeight })
+                    for (auto x : Range{ OutputWidth })
+                        if (RequiresRefinement(y, x) || PixelCircleOfConfusion(y, x) > 1)
+                            for (auto AccumulatedIntensity = SamplePixel(y, x); auto c : Range{ 3 })
+                                AdaptiveImage[c][y][x] = AccumulatedIntensity[c];
+                        else
+                            for (auto c : Range{ 3 })
+                                AdaptiveImage[c][y][x] = ReferenceImage[c][y][x];
+                return AdaptiveImage.Finalize();
+            }
 
-        auto RenderedImage = SupersampledImage.Finalize();
-        for (auto _ : Range{ SupersamplingExponent })
-            RenderedImage = BilinearDownsample(RenderedImage);
+            if (SamplePatternEnabled) {
+                auto SampledImage = Filter::Frame<PixelType>{ OutputHeight, OutputWidth, 3 };
+                for (auto y : Range{ OutputHeight })
+                    for (auto x : Range{ OutputWidth })
+                        for (auto AccumulatedIntensity = SamplePixel(y, x); auto c : Range{ 3 })
+                            SampledImage[c][y][x] = AccumulatedIntensity[c];
+                return SampledImage.Finalize();
+            }
 
-        return RenderedImage;
+            if (Config::enableSampleAccumulation) {
+                auto AccumulatedImage = Filter::Frame<PixelType>{ OutputHeight, OutputWidth, 3 };
+                auto VerticalContributions = ReconstructionWeights(OutputHeight, SupersamplingExponent);
+                auto HorizontalContributions = ReconstructionWeights(OutputWidth, SupersamplingExponent);
+                for (auto y : Range{ Height })
+                    for (auto x : Range{ Width })
+                        for (auto AccumulatedIntensity = TracePrimaryRay(x, y, 1); auto [yOutput, VerticalWeight] : VerticalContributions[y])
+                            for (auto [xOutput, HorizontalWeight] : HorizontalContributions[x])
+                                for (auto c : Range{ 3 })
+                                    AccumulatedImage[c][yOutput][xOutput] += VerticalWeight * HorizontalWeight * AccumulatedIntensity[c];
+                return AccumulatedImage.Finalize();
+            }
+
+            auto TraceSupersampledImage = [&](auto&& SupersampledImage) {
+                for (auto y : Range{ Height })
+                    for (auto x : Range{ Width })
+                        for (auto AccumulatedIntensity = TracePrimaryRay(x, y, 1); auto c : Range{ 3 })
+                            SupersampledImage[c][y][x] = AccumulatedIntensity[c];
+                return SupersampledImage.Finalize();
+            };
+            auto ResampleSupersampledImage = [&](auto&& SupersampledImage) {
+                return WithResamplingKernel([&](auto&& Kernel) {
+                    return WithExecutionPolicy([&](auto&& ExecutionPolicy) {
+                        return Filter::Resample<PixelType>(SupersampledImage, OutputHeight, OutputWidth, Kernel, ExecutionPolicy);
+                    });
+                });
+            };
+            if (Config::ResamplingFilter != "bilinear" && SupersamplingExponent > 0) {
+                if (Config::enableHalfPrecisionSupersampling)
+                    return ResampleSupersampledImage(TraceSupersampledImage(Filter::Frame<Half>{ Height, Width, 3 }));
+                else
+                    return ResampleSupersampledImage(TraceSupersampledImage(Filter::Frame<PixelType>{ Height, Width, 3 }));
+            }
+            if (Config::enableHalfPrecisionSupersampling && SupersamplingExponent > 0) {
+                auto RenderedImage = BilinearDownsample<PixelType>(TraceSupersampledImage(Filter::Frame<Half>{ Height, Width, 3 }));
+                for (auto _ : Range{ 1, SupersamplingExponent })
+                    RenderedImage = BilinearDownsample<PixelType>(RenderedImage);
+                return RenderedImage;
+            }
+
+            auto RenderedImage = TraceSupersampledImage(Filter::Frame<PixelType>{ Height, Width, 3 });
+            for (auto _ : Range{ SupersamplingExponent })
+                RenderedImage = BilinearDownsample<PixelType>(RenderedImage);
+            return RenderedImage;
+        }();
+
+        if (Config::enableDenoising)
+            RenderedImage = WithExecutionPolicy([&](auto&& ExecutionPolicy) {
+                if (Config::enableDepthOfField == false)
+                    return Filter::Denoise(RenderedImage, PrimaryHitNormals, PrimaryHitDepths, PrimaryHitObjectIndices, Config::DenoisingIterations, ExecutionPolicy);
+                return Filter::Denoise(RenderedImage, LensGuideNormals.Finalize(), LensGuideDepths.Finalize(), LensGuideObjectIndices.Finalize(), Config::DenoisingIterations, ExecutionPolicy);
+            });
+
+        if (BandHeight == OutputHeight)
+            return RenderedImage;
+        auto RenderedBand = Filter::Frame<PixelType>{ BandHeight, OutputWidth, 3 };
+        for (auto c : Range{ 3 })
+            for (auto y : Range{ BandHeight })
+                for (auto x : Range{ OutputWidth })
+                    RenderedBand[c][y][x] = RenderedImage[c][y + BandStartpoint - HaloedBandStartpoint][x];
+        return RenderedBand.Finalize();
+    }
+    template<typename PixelType = float>
+    auto Render(auto Height, auto Width, auto SupersamplingExponent, auto&& Metadata, std::ptrdiff_t BandStartpoint, std::ptrdiff_t BandHeight) {
+        return Render<PixelType>(Height, Width, SupersamplingExponent, Metadata, SceneRecords{ Height, SupersamplingExponent, Metadata }, BandStartpoint, BandHeight);
+    }
+    template<typename PixelType = float>
+    auto Render(auto Height, auto Width, auto SupersamplingExponent, auto&& Metadata) {
+        return Render<PixelType>(Height, Width, SupersamplingExponent, Metadata, 0_z, static_cast<std::ptrdiff_t>(Height));
     }
 }
\ No newline at end of file
@@ -0,0 +1,101 @@
+#include "CompiledMesh.h"
+
+#include <cstring>
+#include <fstream>
+#include <iostream>
+#include <type_traits>
+
+namespace {
+    constexpr char compiledMeshSignature[8] = { 'R', 'A', 'Y', 'M', 'E', 'S', 'H', '\0' };
+    constexpr std::uint32_t compiledMeshVersion = 1;
+
+    static_assert(std::is_standard_layout_v<Meshes::BVHNode> && sizeof(Meshes::BVHNode) == 32);
+    static_assert(std::is_standard_layout_v<CompiledMeshHeader>);
+
+    std::uint64_t alignTo16(std::uint64_t offset) {
+        return (offset + 15) & ~std::uint64_t{ 15 };
+    }
+}
+
+bool CompiledMesh::compile(std::span<const Meshes::BVHNode> nodes, std::span<const std::uint32_t> leaves,
+                           const glm::vec3& latticeOrigin, const glm::vec3& latticeStep, std::uint32_t triangleCount,
+                           const std::string& filepath) {
+    CompiledMeshHeader header;
+    std::memset(&header, 0, sizeof(CompiledMeshHeader));
+    std::memcpy(header.signature, compiledMeshSignature, sizeof(compiledMeshSignature));
+    header.version = compiledMeshVersion;
+    header.triangleCount = triangleCount;
+    header.nodeCount = nodes.size();
+    header.nodeOffset = alignTo16(sizeof(CompiledMeshHeader));
+    header.leafWordCount = leaves.size();
+    header.leafOffset = alignTo16(header.nodeOffset + header.nodeCount * sizeof(Meshes::BVHNode));
+    header.latticeOrigin = latticeOrigin;
+    header.latticeStep = latticeStep;
+
+    std::ofstream file(filepath, std::ios::binary);
+    auto writeAt = [&](std::uint64_t offset, const void* data, std::uint64_t size) {
+        static const char padding[16] = {};
+        file.write(padding, offset - static_cast<std::uint64_t>(file.tellp()));
+        file.write(static_cast<const char*>(data), size);
+    };
+    writeAt(0, &header, sizeof(CompiledMeshHeader));
+    writeAt(header.nodeOffset, nodes.data(), header.nodeCount * sizeof(Meshes::BVHNode));
+    writeAt(header.leafOffset, leaves.data(), header.leafWordCount * sizeof(std::uint32_t));
+    if (!file.good()) {
+        std::cout << "could not write " << filepath << std::endl;
+        return false;
+    }
+
+    std::cout << "compiled " << triangleCount << " triangles in " << header.nodeCount << " nodes into " << filepath
+              << " (" << header.leafOffset + header.leafWordCount * sizeof(std::uint32_t) << " bytes)" << std::endl;
+    return true;
+}
+
+bool CompiledMesh::isCompiledMesh(const std::string& filepath) {
+    char signature[sizeof(compiledMeshSignature)] = {};
+    std::ifstream file(filepath, std::ios::binary);
+    file.read(signature, sizeof(signature));
+    return file.good() && std::memcmp(signature, compiledMeshSignature, sizeof(signature)) == 0;
+}
+
+bool CompiledMesh::load(const std::string& filepath) {
+    m_file.setFileName(QString::fromStdString(filepath));
+    if (!m_file.open(QFile::ReadOnly)) {
+        std::cout << "could not open " << filepath << std::endl;
+        return false;
+    }
+
+    // Nothing past the header is touched here, the streams are paged in as the renderer reads them
+    std::uint64_t size = m_file.size();
+    const char* data = reinterpret_cast<const char*>(m_file.map(0, m_file.size()));
+    if (data == nullptr || size < sizeof(CompiledMeshHeader)) {
+        std::cout << "could not map " << filepath << std::endl;
+        return false;
+    }
+
+    CompiledMeshHeader header;
+    std::memcpy(&header, data, sizeof(CompiledMeshHeader));
+    if (std::memcmp(header.signature, compiledMeshSignature, sizeof(compiledMeshSignature)) != 0 || header.version != compiledMeshVersion) {
+        std::cout << filepath << " is not a compiled mesh of version " << compiledMeshVersion << std::endl;
+        return false;
+    }
+
+    auto fits = [&](std::uint64_t offset, std::uint64_t count, std::uint64_t elementSize) {
+        return offset % 16 == 0 && offset <= size && count <= (size - offset) / elementSize;
+    };
+    if (!fits(header.nodeOffset, header.nodeCount, sizeof(Meshes::BVHNode)) ||
+        !fits(header.leafOffset, header.leafWordCount, sizeof(std::uint32_t))) {
+        std::cout << "truncated compiled mesh " << filepath << std::endl;
+        return false;
+    }
+
+    nodes = { reinterpret_cast<const Meshes::BVHNode*>(data + header.nodeOffset), header.nodeCount };
+    leaves = { reinterpret_cast<const std::uint32_t*>(data + header.leafOffset), header.leafWordCount };
+    latticeOrigin = header.latticeOrigin;
+    latticeStep = header.latticeStep;
+    triangleCount = header.triangleCount;
+
+    std::cout << "mapped compiled mesh " << filepath << " (" << triangleCount << " triangles, "
+              << header.nodeCount << " nodes)" << std::endl;
+    return true;
+}
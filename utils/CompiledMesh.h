@@ -0,0 +1,64 @@
+#ifndef COMPILEDMESH_H
+#define COMPILEDMESH_H
+
+#include <cstdint>
+#include <span>
+#include <string>
+
+#include <QFile>
+#include "glm/glm.hpp"
+#include "../BVHNode.hxx"
+
+/**
+ * On-disk layout of a compiled mesh. The file is a header followed by the bounding volume
+ * hierarchy and the encoded leaves, each starting on a 16-byte boundary. Nodes are
+ * Meshes::BVHNode records stored depth first, and a leaf node's offset counts 32-bit words
+ * into the leaf stream; see Meshes::QuantizedMesh for how a leaf is encoded.
+ */
+struct CompiledMeshHeader {
+    char signature[8];
+    std::uint32_t version;
+    std::uint32_t triangleCount;
+
+    std::uint64_t nodeCount;
+    std::uint64_t nodeOffset;
+    std::uint64_t leafWordCount;
+    std::uint64_t leafOffset;
+
+    // Decoded positions are latticeOrigin + coordinate * latticeStep per axis
+    glm::vec3 latticeOrigin;
+    glm::vec3 latticeStep;
+};
+
+/**
+ * @class CompiledMesh
+ *
+ * A mesh quantized ahead of time, written by compile() and memory-mapped by load(). Only the
+ * header is read when loading; the node and leaf streams point straight into the mapping, so
+ * the operating system pages geometry in as rays reach it and meshes larger than memory stay
+ * renderable.
+ */
+class CompiledMesh {
+public:
+    // Write an encoded mesh to filepath. Returns false if the file cannot be written.
+    static bool compile(std::span<const Meshes::BVHNode> nodes, std::span<const std::uint32_t> leaves,
+                        const glm::vec3& latticeOrigin, const glm::vec3& latticeStep, std::uint32_t triangleCount,
+                        const std::string& filepath);
+
+    // Whether filepath starts with the compiled mesh signature.
+    static bool isCompiledMesh(const std::string& filepath);
+
+    // Map filepath into memory. Returns false if the file is missing or its header is malformed.
+    bool load(const std::string& filepath);
+
+    std::span<const Meshes::BVHNode> nodes;
+    std::span<const std::uint32_t> leaves;
+    glm::vec3 latticeOrigin;
+    glm::vec3 latticeStep;
+    std::uint32_t triangleCount = 0;
+
+private:
+    QFile m_file;
+};
+
+#endif // COMPILEDMESH_H
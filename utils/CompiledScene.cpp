@@ -0,0 +1,187 @@
+#include "CompiledScene.h"
+
+#include <cstring>
+#include <fstream>
+#include <iostream>
+#include <type_traits>
+#include <unordered_map>
+#include <vector>
+
+namespace {
+    constexpr char compiledSceneSignature[8] = { 'R', 'A', 'Y', 'S', 'C', 'E', 'N', 'E' };
+    constexpr std::uint32_t compiledSceneVersion = 1;
+
+    // glm declares its own copy constructors, so the tables are only required to be plain layouts
+    static_assert(std::is_standard_layout_v<SceneGlobalData> && std::is_standard_layout_v<SceneCameraData>);
+    static_assert(std::is_standard_layout_v<SceneLightData> && std::is_standard_layout_v<CompiledMaterial>);
+    static_assert(std::is_standard_layout_v<CompiledShape> && std::is_standard_layout_v<CompiledSceneHeader>);
+
+    std::uint64_t alignTo16(std::uint64_t offset) {
+        return (offset + 15) & ~std::uint64_t{ 15 };
+    }
+}
+
+bool CompiledScene::compile(const RenderData& renderData, const std::string& filepath) {
+    // Intern strings so every filename is stored once
+    std::string strings;
+    std::unordered_map<std::string, std::uint32_t> stringOffsets;
+    auto internString = [&](const std::string& s) {
+        auto [entry, inserted] = stringOffsets.try_emplace(s, static_cast<std::uint32_t>(strings.size()));
+        if (inserted)
+            strings += s;
+        return entry->second;
+    };
+    auto compileMap = [&](const SceneFileMap& map) {
+        CompiledFileMap compiledMap = {};
+        compiledMap.isUsed = map.isUsed;
+        compiledMap.filenameOffset = internString(map.filename);
+        compiledMap.filenameLength = static_cast<std::uint32_t>(map.filename.size());
+        compiledMap.repeatU = map.repeatU;
+        compiledMap.repeatV = map.repeatV;
+        return compiledMap;
+    };
+
+    // Materials arrive already interned, so the table maps one to one
+    std::vector<CompiledMaterial> materials(renderData.materials.size());
+    for (size_t i = 0; i < renderData.materials.size(); i++) {
+        const SceneMaterial& mat = renderData.materials[i];
+
+        CompiledMaterial& material = materials[i];
+        std::memset(&material, 0, sizeof(CompiledMaterial));
+        material.cDiffuse = mat.cDiffuse;
+        material.cAmbient = mat.cAmbient;
+        material.cReflective = mat.cReflective;
+        material.cSpecular = mat.cSpecular;
+        material.cTransparent = mat.cTransparent;
+        material.cEmissive = mat.cEmissive;
+        material.textureMap = compileMap(mat.textureMap);
+        material.bumpMap = compileMap(mat.bumpMap);
+        material.blend = mat.blend;
+        material.shininess = mat.shininess;
+        material.ior = mat.ior;
+    }
+
+    std::vector<CompiledShape> shapes(renderData.shapes.size());
+    for (size_t i = 0; i < renderData.shapes.size(); i++) {
+        const RenderShapeData& shape = renderData.shapes[i];
+        const std::string& meshfile = shape.type == PrimitiveType::PRIMITIVE_MESH ? renderData.meshfiles[shape.meshfileIndex] : std::string();
+
+        CompiledShape& compiledShape = shapes[i];
+        std::memset(&compiledShape, 0, sizeof(CompiledShape));
+        compiledShape.ctm = shape.ctm;
+        compiledShape.inverseCtm = glm::inverse(shape.ctm);
+        compiledShape.normalMatrix = glm::inverse(glm::transpose(glm::mat3{ shape.ctm }));
+        compiledShape.type = shape.type;
+        compiledShape.materialIndex = shape.materialIndex;
+        compiledShape.meshfileOffset = internString(meshfile);
+        compiledShape.meshfileLength = static_cast<std::uint32_t>(meshfile.size());
+    }
+
+    CompiledSceneHeader header;
+    std::memset(&header, 0, sizeof(CompiledSceneHeader));
+    std::memcpy(header.signature, compiledSceneSignature, sizeof(compiledSceneSignature));
+    header.version = compiledSceneVersion;
+    header.lightCount = static_cast<std::uint32_t>(renderData.lights.size());
+    header.materialCount = static_cast<std::uint32_t>(materials.size());
+    header.shapeCount = static_cast<std::uint32_t>(shapes.size());
+    header.lightOffset = alignTo16(sizeof(CompiledSceneHeader));
+    header.materialOffset = alignTo16(header.lightOffset + header.lightCount * sizeof(SceneLightData));
+    header.shapeOffset = alignTo16(header.materialOffset + header.materialCount * sizeof(CompiledMaterial));
+    header.stringOffset = alignTo16(header.shapeOffset + header.shapeCount * sizeof(CompiledShape));
+    header.stringSize = strings.size();
+    header.globalData = renderData.globalData;
+    header.cameraData = renderData.cameraData;
+
+    std::ofstream file(filepath, std::ios::binary);
+    auto writeAt = [&](std::uint64_t offset, const void* data, std::uint64_t size) {
+        static const char padding[16] = {};
+        file.write(padding, offset - static_cast<std::uint64_t>(file.tellp()));
+        file.write(static_cast<const char*>(data), size);
+    };
+    writeAt(0, &header, sizeof(CompiledSceneHeader));
+    writeAt(header.lightOffset, renderData.lights.data(), header.lightCount * sizeof(SceneLightData));
+    writeAt(header.materialOffset, materials.data(), header.materialCount * sizeof(CompiledMaterial));
+    writeAt(header.shapeOffset, shapes.data(), header.shapeCount * sizeof(CompiledShape));
+    writeAt(header.stringOffset, strings.data(), header.stringSize);
+    if (!file.good()) {
+        std::cout << "could not write " << filepath << std::endl;
+        return false;
+    }
+
+    std::cout << "compiled " << header.shapeCount << " shapes with " << header.materialCount << " materials into "
+         << filepath << std::endl;
+    return true;
+}
+
+bool CompiledScene::isCompiledScene(const std::string& filepath) {
+    char signature[sizeof(compiledSceneSignature)] = {};
+    std::ifstream file(filepath, std::ios::binary);
+    file.read(signature, sizeof(signature));
+    return file.good() && std::memcmp(signature, compiledSceneSignature, sizeof(signature)) == 0;
+}
+
+bool CompiledScene::load(const std::string& filepath) {
+    m_file.setFileName(QString::fromStdString(filepath));
+    if (!m_file.open(QFile::ReadOnly)) {
+        std::cout << "could not open " << filepath << std::endl;
+        return false;
+    }
+
+    // The tables are used in place, straight from the mapping
+    std::uint64_t size = m_file.size();
+    const char* data = reinterpret_cast<const char*>(m_file.map(0, m_file.size()));
+    if (data == nullptr || size < sizeof(CompiledSceneHeader)) {
+        std::cout << "could not map " << filepath << std::endl;
+        return false;
+    }
+
+    CompiledSceneHeader header;
+    std::memcpy(&header, data, sizeof(CompiledSceneHeader));
+    if (std::memcmp(header.signature, compiledSceneSignature, sizeof(compiledSceneSignature)) != 0 || header.version != compiledSceneVersion) {
+        std::cout << filepath << " is not a compiled scene of version " << compiledSceneVersion << std::endl;
+        return false;
+    }
+
+    auto fits = [&](std::uint64_t offset, std::uint64_t count, std::uint64_t elementSize) {
+        return offset % 16 == 0 && offset <= size && count <= (size - offset) / elementSize;
+    };
+    if (!fits(header.lightOffset, header.lightCount, sizeof(SceneLightData)) ||
+        !fits(header.materialOffset, header.materialCount, sizeof(CompiledMaterial)) ||
+        !fits(header.shapeOffset, header.shapeCount, sizeof(CompiledShape)) ||
+        !fits(header.stringOffset, header.stringSize, 1)) {
+        std::cout << "truncated compiled scene " << filepath << std::endl;
+        return false;
+    }
+
+    globalData = header.globalData;
+    cameraData = header.cameraData;
+    lights = { reinterpret_cast<const SceneLightData*>(data + header.lightOffset), header.lightCount };
+    materials = { reinterpret_cast<const CompiledMaterial*>(data + header.materialOffset), header.materialCount };
+    shapes = { reinterpret_cast<const CompiledShape*>(data + header.shapeOffset), header.shapeCount };
+    m_strings = { data + header.stringOffset, header.stringSize };
+
+    auto inStringTable = [&](std::uint32_t offset, std::uint32_t length) {
+        return std::uint64_t{ offset } + length <= header.stringSize;
+    };
+    for (const CompiledMaterial& material : materials) {
+        if (!inStringTable(material.textureMap.filenameOffset, material.textureMap.filenameLength) ||
+            !inStringTable(material.bumpMap.filenameOffset, material.bumpMap.filenameLength)) {
+            std::cout << "corrupted material table in " << filepath << std::endl;
+            return false;
+        }
+    }
+    for (const CompiledShape& shape : shapes) {
+        if (shape.materialIndex >= header.materialCount || !inStringTable(shape.meshfileOffset, shape.meshfileLength)) {
+            std::cout << "corrupted shape table in " << filepath << std::endl;
+            return false;
+        }
+    }
+
+    std::cout << "loaded compiled scene " << filepath << " (" << header.shapeCount << " shapes, "
+         << header.materialCount << " materials)" << std::endl;
+    return true;
+}
+
+std::string_view CompiledScene::string(std::uint32_t offset, std::uint32_t length) const {
+    return std::string_view(m_strings.data() + offset, length);
+}
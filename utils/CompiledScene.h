@@ -0,0 +1,106 @@
+#ifndef COMPILEDSCENE_H
+#define COMPILEDSCENE_H
+
+#include "SceneData.h"
+#include "SceneParser.h"
+
+#include <cstdint>
+#include <span>
+#include <string>
+#include <string_view>
+
+#include <QFile>
+
+/**
+ * On-disk layout of a compiled scene. The file is a header followed by the light, material and
+ * shape tables and a string table, each starting on a 16-byte boundary. Everything is stored in
+ * native byte order so a mapped file can be used in place without any decoding.
+ */
+struct CompiledFileMap {
+    std::uint32_t isUsed;
+    std::uint32_t filenameOffset;  // Into the string table
+    std::uint32_t filenameLength;
+    float repeatU;
+    float repeatV;
+};
+
+struct CompiledMaterial {
+    SceneColor cDiffuse;
+    SceneColor cAmbient;
+    SceneColor cReflective;
+    SceneColor cSpecular;
+    SceneColor cTransparent;
+    SceneColor cEmissive;
+
+    CompiledFileMap textureMap;
+    CompiledFileMap bumpMap;
+
+    float blend;
+    float shininess;
+    float ior;
+};
+
+struct CompiledShape {
+    // The cumulative transformation matrix and the matrices derived from it
+    glm::mat4 ctm;
+    glm::mat4 inverseCtm;
+    glm::mat3 normalMatrix;
+
+    PrimitiveType type;
+    std::uint32_t materialIndex;   // Into the material table
+    std::uint32_t meshfileOffset;  // Into the string table, only applicable to meshes
+    std::uint32_t meshfileLength;
+};
+
+struct CompiledSceneHeader {
+    char signature[8];
+    std::uint32_t version;
+
+    std::uint32_t lightCount;
+    std::uint32_t materialCount;
+    std::uint32_t shapeCount;
+    std::uint64_t lightOffset;
+    std::uint64_t materialOffset;
+    std::uint64_t shapeOffset;
+    std::uint64_t stringOffset;
+    std::uint64_t stringSize;
+
+    SceneGlobalData globalData;
+    SceneCameraData cameraData;
+};
+
+/**
+ * @class CompiledScene
+ *
+ * A scene flattened ahead of time by compile() and memory-mapped by load(). The tables below
+ * point straight into the mapping, so a loaded scene is ready to render without any parsing.
+ * It exposes the same globalData / cameraData / lights / shapes members the renderer reads
+ * from RenderData, with materials interned into a table that shapes refer to by index.
+ */
+class CompiledScene {
+public:
+    // Flatten renderData and write it to filepath. Returns false if the file cannot be written.
+    static bool compile(const RenderData& renderData, const std::string& filepath);
+
+    // Whether filepath starts with the compiled scene signature.
+    static bool isCompiledScene(const std::string& filepath);
+
+    // Map filepath into memory. Returns false if the file is missing or malformed.
+    bool load(const std::string& filepath);
+
+    // Resolve a string stored in the string table, e.g. a texture or mesh filename.
+    std::string_view string(std::uint32_t offset, std::uint32_t length) const;
+
+    SceneGlobalData globalData;
+    SceneCameraData cameraData;
+
+    std::span<const SceneLightData> lights;
+    std::span<const CompiledMaterial> materials;
+    std::span<const CompiledShape> shapes;
+
+private:
+    QFile m_file;
+    std::span<const char> m_strings;
+};
+
+#endif // COMPILEDSCENE_H
@@ -9,6 +9,7 @@
 
 #include <vector>
 #include <string>
+#include <memory_resource>
 
 #include "glm/glm.hpp"
 
@@ -156,13 +157,20 @@ struct SceneTransformation {
     glm::mat4x4 matrix;
 };
 
-// Structure for non-primitive scene objects
+// Structure for non-primitive scene objects. Nodes are allocator-aware so that a node created
+// from an arena keeps its transformations and child lists in the same arena.
 struct SceneNode {
-   std::vector<SceneTransformation*> transformations;
+   using allocator_type = std::pmr::polymorphic_allocator<>;
 
-   std::vector<ScenePrimitive*> primitives;
+   SceneNode() = default;
+   explicit SceneNode(const allocator_type& allocator)
+       : transformations(allocator), primitives(allocator), children(allocator) {}
 
-   std::vector<SceneNode*> children;
+   std::pmr::vector<SceneTransformation> transformations;
+
+   std::pmr::vector<ScenePrimitive*> primitives;
+
+   std::pmr::vector<SceneNode*> children;
 };
 
 #endif
@@ -3,28 +3,56 @@
 #include "glm/gtx/transform.hpp"
 
 #include <iostream>
+#include <unordered_map>
 #include "../Infrastructure.hxx"
 
 using namespace std;
 
-auto DFSTraversal(auto& Shapes, auto&& ParentTransformation, auto Node)->void {
+auto MaterialSignature(const SceneMaterial& Material) {
+    auto Signature = std::string{};
+    auto Append = [&](auto&& Value) { Signature.append(reinterpret_cast<const char*>(&Value), sizeof(Value)); };
+    for (auto&& Color : { Material.cDiffuse, Material.cAmbient, Material.cReflective, Material.cSpecular, Material.cTransparent, Material.cEmissive })
+        Append(Color);
+    for (auto Map : { &Material.textureMap, &Material.bumpMap }) {
+        Append(Map->isUsed);
+        Append(Map->repeatU);
+        Append(Map->repeatV);
+        Append(Map->filename.size());
+        Signature += Map->filename;
+    }
+    Append(Material.blend);
+    Append(Material.shininess);
+    Append(Material.ior);
+    return Signature;
+}
+
+auto Intern(auto& Table, auto& Indices, auto&& Key, auto&& Value) {
+    auto [Entry, Inserted] = Indices.try_emplace(Forward(Key), static_cast<std::uint32_t>(Table.size()));
+    if (Inserted)
+        Table.push_back(Forward(Value));
+    return Entry->second;
+}
+
+auto DFSTraversal(auto& Shapes, auto&& InternPrimitive, auto&& ParentTransformation, auto Node)->void {
     auto FusedTransformation = ParentTransformation;
-    for (auto x : Node->transformations)
+    for (auto&& x : Node->transformations)
         FusedTransformation *= [&] {
-            if (x->type == TRANSFORMATION_TRANSLATE)
-                return glm::translate(x->translate);
-            else if (x->type == TRANSFORMATION_SCALE)
-                return glm::scale(x->scale);
-            else if (x->type == TRANSFORMATION_ROTATE)
-                return glm::rotate(x->angle, x->rotate);
-            else if (x->type == TRANSFORMATION_MATRIX)
-                return x->matrix;
+            if (x.type == TRANSFORMATION_TRANSLATE)
+                return glm::translate(x.translate);
+            else if (x.type == TRANSFORMATION_SCALE)
+                return glm::scale(x.scale);
+            else if (x.type == TRANSFORMATION_ROTATE)
+                return glm::rotate(x.angle, x.rotate);
+            else if (x.type == TRANSFORMATION_MATRIX)
+                return x.matrix;
             throw std::runtime_error{ "Unrecognized transformation type detected!" };
         }();
-    for (auto x : Node->primitives)
-        Shapes.push_back({ .primitive = *x, .ctm = FusedTransformation });
+    for (auto x : Node->primitives) {
+        auto [MaterialIndex, MeshfileIndex] = InternPrimitive(x);
+        Shapes.push_back({ .type = x->type, .materialIndex = MaterialIndex, .meshfileIndex = MeshfileIndex, .ctm = FusedTransformation });
+    }
     for (auto x : Node->children)
-        DFSTraversal(Shapes, FusedTransformation, x);
+        DFSTraversal(Shapes, InternPrimitive, FusedTransformation, x);
 }
 
 bool SceneParser::parse(std::string filepath, RenderData &renderData) {
@@ -39,7 +67,20 @@ bool SceneParser::parse(std::string filepath, RenderData &renderData) {
     renderData.lights.resize(fileReader->getNumLights());
     for (auto x : Range{ fileReader->getNumLights() })
         fileReader->getLightData(x, renderData.lights[x]);
-    DFSTraversal(renderData.shapes, glm::mat4{ 1 }, fileReader->getRootNode());
+
+    // instances of a master object share their ScenePrimitive, so most shapes are resolved by the pointer cache
+    // and only distinct primitives pay for hashing their material
+    auto MaterialIndices = std::unordered_map<std::string, std::uint32_t>{};
+    auto MeshfileIndices = std::unordered_map<std::string, std::uint32_t>{};
+    auto PrimitiveIndices = std::unordered_map<const ScenePrimitive*, std::array<std::uint32_t, 2>>{};
+    auto InternPrimitive = [&](const ScenePrimitive* Primitive) {
+        if (auto Entry = PrimitiveIndices.find(Primitive); Entry != PrimitiveIndices.end())
+            return Entry->second;
+        auto MaterialIndex = Intern(renderData.materials, MaterialIndices, MaterialSignature(Primitive->material), Primitive->material);
+        auto MeshfileIndex = Primitive->type == PrimitiveType::PRIMITIVE_MESH ? Intern(renderData.meshfiles, MeshfileIndices, Primitive->meshfile, Primitive->meshfile) : 0u;
+        return PrimitiveIndices[Primitive] = std::array{ MaterialIndex, MeshfileIndex };
+    };
+    DFSTraversal(renderData.shapes, InternPrimitive, glm::mat4{ 1 }, fileReader->getRootNode());
 
     return true;
 }
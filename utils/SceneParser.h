@@ -2,12 +2,17 @@
 #define SCENEPARSER_H
 
 #include "SceneData.h"
+#include <cstdint>
 #include <vector>
 #include <string>
 
 struct RenderShapeData {
-    // The primitive description structure
-    ScenePrimitive primitive;
+    // The primitive type
+    PrimitiveType type;
+    // Index into RenderData::materials
+    std::uint32_t materialIndex;
+    // Index into RenderData::meshfiles, only applicable to meshes
+    std::uint32_t meshfileIndex;
     // The cumulative transformation matrix
     glm::mat4 ctm;
 };
@@ -17,6 +22,9 @@ struct RenderData {
     SceneCameraData cameraData;
 
     std::vector<SceneLightData> lights;
+    // Materials and mesh filenames are interned, every shape refers to them by index
+    std::vector<SceneMaterial> materials;
+    std::vector<std::string> meshfiles;
     std::vector<RenderShapeData> shapes;
 };
 
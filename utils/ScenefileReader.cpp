@@ -9,16 +9,18 @@
 #include "glm/gtc/type_ptr.hpp"
 
 #include <cassert>
+#include <chrono>
 #include <cstring>
 #include <iostream>
+#include <memory>
 
 #include <QFile>
 
 #define ERROR_AT(e) "error at line " << e.lineNumber() << " col " << e.columnNumber() << ": "
-#define PARSE_ERROR(e) std::cout << ERROR_AT(e) << "could not parse <" << e.tagName().toStdString() \
+#define PARSE_ERROR(e) std::cout << ERROR_AT(e) << "could not parse <" << e.name().toString().toStdString() \
     << ">" << std::endl
 #define UNSUPPORTED_ELEMENT(e) std::cout << ERROR_AT(e) << "unsupported element <" \
-    << e.tagName().toStdString() << ">" << std::endl;
+    << e.name().toString().toStdString() << ">" << std::endl;
 
 ScenefileReader::ScenefileReader(const std::string& name)
 {
@@ -28,33 +30,33 @@ ScenefileReader::ScenefileReader(const std::string& name)
     memset(&m_globalData, 0, sizeof(SceneGlobalData));
     m_objects.clear();
     m_lights.clear();
-    m_nodes.clear();
 }
 
 ScenefileReader::~ScenefileReader()
 {
-    std::vector<SceneLightData*>::iterator lights;
-    for (lights = m_lights.begin(); lights != m_lights.end(); lights++) {
-        delete *lights;
+    // Everything else, nodes and their lists included, goes away with the arena
+    for (size_t i = 0; i < m_primitives.size(); i++) {
+        std::destroy_at(m_primitives[i]);
     }
+}
 
-    // Delete all Scene Nodes
-    for (unsigned int node = 0; node < m_nodes.size(); node++) {
-        for (size_t i = 0; i < (m_nodes[node])->transformations.size(); i++) {
-            delete (m_nodes[node])->transformations[i];
-        }
-        for (size_t i = 0; i < (m_nodes[node])->primitives.size(); i++) {
-            delete (m_nodes[node])->primitives[i];
-        }
-        (m_nodes[node])->transformations.clear();
-        (m_nodes[node])->primitives.clear();
-        (m_nodes[node])->children.clear();
-        delete m_nodes[node];
-    }
+void* CountingMemoryResource::do_allocate(size_t size, size_t alignment) {
+    allocations++;
+    bytes += size;
+    return m_upstream->allocate(size, alignment);
+}
 
-    m_nodes.clear();
-    m_lights.clear();
-    m_objects.clear();
+void CountingMemoryResource::do_deallocate(void* p, size_t size, size_t alignment) {
+    m_upstream->deallocate(p, size, alignment);
+}
+
+bool CountingMemoryResource::do_is_equal(const std::pmr::memory_resource& other) const noexcept {
+    return this == &other;
+}
+
+SceneNode* ScenefileReader::createNode() {
+    m_parseStatistics.nodes++;
+    return m_allocator.new_object<SceneNode>();
 }
 
 void ScenefileReader::getGlobalData(SceneGlobalData& data) const {
@@ -76,10 +78,14 @@ void ScenefileReader::getLightData(int i, SceneLightData& data) const {
         std::cout << "invalid light index %d" << std::endl;
         throw std::invalid_argument("index out of range");
     }
-    data = *m_lights[i];
+    data = m_lights[i];
     return;
 }
 
+const SceneParseStatistics& ScenefileReader::getParseStatistics() const {
+    return m_parseStatistics;
+}
+
 SceneNode* ScenefileReader::getRootNode() const {
     std::map<std::string, SceneNode*>::iterator node = m_objects.find("root");
     if (node == m_objects.end())
@@ -87,29 +93,37 @@ SceneNode* ScenefileReader::getRootNode() const {
     return m_objects["root"];
 }
 
+/**
+ * Helper function to report a malformed document once the stream reader gives up.
+ */
+bool reportStreamError(const QXmlStreamReader &reader) {
+    std::cout << "parse error at line " << reader.lineNumber() << " col " << reader.columnNumber() << ": "
+         << reader.errorString().toStdString() << std::endl;
+    return false;
+}
+
 // This is where it all goes down...
 bool ScenefileReader::readXML() {
+    auto startTime = std::chrono::steady_clock::now();
+
     // Read the file
     QFile file(file_name.c_str());
     if (!file.open(QFile::ReadOnly)) {
         std::cout << "could not open " << file_name << std::endl;
         return false;
     }
+    m_parseStatistics = SceneParseStatistics();
+    m_parseStatistics.bytes = file.size();
 
-    // Load the XML document
-    QDomDocument doc;
-    QString errorMessage;
-    int errorLine, errorColumn;
-    if (!doc.setContent(&file, &errorMessage, &errorLine, &errorColumn)) {
-        std::cout << "parse error at line " << errorLine << " col " << errorColumn << ": "
-             << errorMessage.toStdString() << std::endl;
-        return false;
-    }
-    file.close();
+    // Stream the XML document: elements are turned into scene nodes as they are read,
+    // so no DOM is ever built and the file is pulled in through the reader's own buffer.
+    QXmlStreamReader reader(&file);
 
     // Get the root element
-    QDomElement scenefile = doc.documentElement();
-    if (scenefile.tagName() != "scenefile") {
+    if (!reader.readNextStartElement()) {
+        return reportStreamError(reader);
+    }
+    if (reader.name() != u"scenefile") {
         std::cout << "missing <scenefile>" << std::endl;
         return false;
     }
@@ -129,29 +143,37 @@ bool ScenefileReader::readXML() {
     m_globalData.ks = 0.5f;
 
     // Iterate over child elements
-    QDomNode childNode = scenefile.firstChild();
-    while (!childNode.isNull()) {
-        QDomElement e = childNode.toElement();
-        if (e.tagName() == "globaldata") {
-            if (!parseGlobalData(e))
+    while (reader.readNextStartElement()) {
+        if (reader.name() == u"globaldata") {
+            if (!parseGlobalData(reader))
                 return false;
-        } else if (e.tagName() == "lightdata") {
-            if (!parseLightData(e))
+        } else if (reader.name() == u"lightdata") {
+            if (!parseLightData(reader))
                 return false;
-        } else if (e.tagName() == "cameradata") {
-            if (!parseCameraData(e))
+        } else if (reader.name() == u"cameradata") {
+            if (!parseCameraData(reader))
                 return false;
-        } else if (e.tagName() == "object") {
-            if (!parseObjectData(e))
+        } else if (reader.name() == u"object") {
+            if (!parseObjectData(reader))
                 return false;
-        } else if (!e.isNull()) {
-            UNSUPPORTED_ELEMENT(e);
+        } else {
+            UNSUPPORTED_ELEMENT(reader);
             return false;
         }
-        childNode = childNode.nextSibling();
     }
+    if (reader.hasError()) {
+        return reportStreamError(reader);
+    }
+    file.close();
 
-    std::cout << "finished parsing " << file_name << std::endl;
+    m_parseStatistics.seconds = std::chrono::duration<double>(std::chrono::steady_clock::now() - startTime).count();
+    m_parseStatistics.arenaAllocations = m_arenaRequests.allocations;
+    m_parseStatistics.heapAllocations = m_heap.allocations;
+    m_parseStatistics.heapBytes = m_heap.bytes;
+    std::cout << "finished parsing " << file_name << " (" << m_parseStatistics.bytes / 1048576. << " MB in "
+         << m_parseStatistics.seconds << " s, " << m_parseStatistics.throughput() << " MB/s; "
+         << m_parseStatistics.nodes << " nodes, " << m_parseStatistics.arenaAllocations << " allocations served from "
+         << m_parseStatistics.heapAllocations << " heap blocks)" << std::endl;
     return true;
 }
 
@@ -159,10 +181,10 @@ bool ScenefileReader::readXML() {
  * Helper function to parse a single value, the name of which is stored in
  * name.  For example, to parse <length v="0"/>, name would need to be "v".
  */
-bool parseInt(const QDomElement &single, int &a, const char *name) {
+bool parseInt(const QXmlStreamAttributes &single, int &a, const char *name) {
     if (!single.hasAttribute(name))
         return false;
-    a = single.attribute(name).toInt();
+    a = single.value(name).toInt();
     return true;
 }
 
@@ -170,10 +192,10 @@ bool parseInt(const QDomElement &single, int &a, const char *name) {
  * Helper function to parse a single value, the name of which is stored in
  * name.  For example, to parse <length v="0"/>, name would need to be "v".
  */
-template <typename T> bool parseSingle(const QDomElement &single, T &a, const QString &str) {
+template <typename T> bool parseSingle(const QXmlStreamAttributes &single, T &a, const QString &str) {
     if (!single.hasAttribute(str))
         return false;
-    a = single.attribute(str).toDouble();
+    a = single.value(str).toDouble();
     return true;
 }
 
@@ -183,7 +205,7 @@ template <typename T> bool parseSingle(const QDomElement &single, T &a, const QS
  * <pos x="0" y="0" z="0"/>, chars would need to be "xyz".
  */
 template <typename T> bool parseTriple(
-        const QDomElement &triple,
+        const QXmlStreamAttributes &triple,
         T &a,
         T &b,
         T &c,
@@ -194,9 +216,9 @@ template <typename T> bool parseTriple(
         !triple.hasAttribute(str_b) ||
         !triple.hasAttribute(str_c))
         return false;
-    a = triple.attribute(str_a).toDouble();
-    b = triple.attribute(str_b).toDouble();
-    c = triple.attribute(str_c).toDouble();
+    a = triple.value(str_a).toDouble();
+    b = triple.value(str_b).toDouble();
+    c = triple.value(str_c).toDouble();
     return true;
 }
 
@@ -206,7 +228,7 @@ template <typename T> bool parseTriple(
  * <color r="0" g="0" b="0" a="0"/>, chars would need to be "rgba".
  */
 template <typename T> bool parseQuadruple(
-        const QDomElement &quadruple,
+        const QXmlStreamAttributes &quadruple,
         T &a,
         T &b,
         T &c,
@@ -220,10 +242,10 @@ template <typename T> bool parseQuadruple(
         !quadruple.hasAttribute(str_c) ||
         !quadruple.hasAttribute(str_d))
         return false;
-    a = quadruple.attribute(str_a).toDouble();
-    b = quadruple.attribute(str_b).toDouble();
-    c = quadruple.attribute(str_c).toDouble();
-    d = quadruple.attribute(str_d).toDouble();
+    a = quadruple.value(str_a).toDouble();
+    b = quadruple.value(str_b).toDouble();
+    c = quadruple.value(str_c).toDouble();
+    d = quadruple.value(str_d).toDouble();
     return true;
 }
 
@@ -240,27 +262,27 @@ template <typename T> bool parseQuadruple(
  *   <row a="0" b="0" c="0" d="1"/>
  * </matrix>
  */
-bool parseMatrix(const QDomElement &matrix, glm::mat4 &m) {
+bool parseMatrix(QXmlStreamReader &reader, glm::mat4 &m) {
     float *valuePtr = glm::value_ptr(m);
-    QDomNode childNode = matrix.firstChild();
     int col = 0;
 
-    while (!childNode.isNull()) {
-        QDomElement e = childNode.toElement();
-        if (e.isElement()) {
+    // Rows past the fourth are skipped along with the rest of the element
+    while (reader.readNextStartElement()) {
+        if (col < 4) {
+            QXmlStreamAttributes e = reader.attributes();
             float a, b, c, d;
             if (!parseQuadruple(e, a, b, c, d, "a", "b", "c", "d")
                     && !parseQuadruple(e, a, b, c, d, "v1", "v2", "v3", "v4")) {
-                PARSE_ERROR(e);
+                PARSE_ERROR(reader);
                 return false;
             }
             valuePtr[0*4 + col] = a;
             valuePtr[1*4 + col] = b;
             valuePtr[2*4 + col] = c;
             valuePtr[3*4 + col] = d;
-            if (++col == 4) break;
+            ++col;
         }
-        childNode = childNode.nextSibling();
+        reader.skipCurrentElement();
     }
 
     return (col == 4);
@@ -270,7 +292,7 @@ bool parseMatrix(const QDomElement &matrix, glm::mat4 &m) {
  * Helper function to parse a color.  Will parse an element with r, g, b, and
  * a attributes (the a attribute is optional and defaults to 1).
  */
-bool parseColor(const QDomElement &color, SceneColor &c) {
+bool parseColor(const QXmlStreamAttributes &color, SceneColor &c) {
     c.a = 1;
     return parseQuadruple(color, c.r, c.g, c.b, c.a, "r", "g", "b", "a") ||
            parseQuadruple(color, c.r, c.g, c.b, c.a, "x", "y", "z", "w") ||
@@ -282,12 +304,12 @@ bool parseColor(const QDomElement &color, SceneColor &c) {
  * Helper function to parse a texture map tag.  Example texture map tag:
  * <texture file="/course/cs123/data/image/andyVanDam.jpg" u="1" v="1"/>
  */
-bool parseMap(const QDomElement &e, SceneFileMap &map) {
+bool parseMap(const QXmlStreamAttributes &e, SceneFileMap &map) {
     if (!e.hasAttribute("file"))
         return false;
-    map.filename = e.attribute("file").toStdString();
-    map.repeatU = e.hasAttribute("u") ? e.attribute("u").toFloat() : 1;
-    map.repeatV = e.hasAttribute("v") ? e.attribute("v").toFloat() : 1;
+    map.filename = e.value("file").toString().toStdString();
+    map.repeatU = e.hasAttribute("u") ? e.value("u").toFloat() : 1;
+    map.repeatV = e.hasAttribute("v") ? e.value("v").toFloat() : 1;
     map.isUsed = true;
     return true;
 }
@@ -295,33 +317,32 @@ bool parseMap(const QDomElement &e, SceneFileMap &map) {
 /**
  * Parse a <globaldata> tag and fill in m_globalData.
  */
-bool ScenefileReader::parseGlobalData(const QDomElement &globaldata) {
+bool ScenefileReader::parseGlobalData(QXmlStreamReader &reader) {
     // Iterate over child elements
-    QDomNode childNode = globaldata.firstChild();
-    while (!childNode.isNull()) {
-        QDomElement e = childNode.toElement();
-        if (e.tagName() == "ambientcoeff") {
+    while (reader.readNextStartElement()) {
+        QXmlStreamAttributes e = reader.attributes();
+        if (reader.name() == u"ambientcoeff") {
             if (!parseSingle(e, m_globalData.ka, "v")) {
-                PARSE_ERROR(e);
+                PARSE_ERROR(reader);
                 return false;
             }
-        } else if (e.tagName() == "diffusecoeff") {
+        } else if (reader.name() == u"diffusecoeff") {
             if (!parseSingle(e, m_globalData.kd, "v")) {
-                PARSE_ERROR(e);
+                PARSE_ERROR(reader);
                 return false;
             }
-        } else if (e.tagName() == "specularcoeff") {
+        } else if (reader.name() == u"specularcoeff") {
             if (!parseSingle(e, m_globalData.ks, "v")) {
-                PARSE_ERROR(e);
+                PARSE_ERROR(reader);
                 return false;
             }
-        } else if (e.tagName() == "transparentcoeff") {
+        } else if (reader.name() == u"transparentcoeff") {
             if (!parseSingle(e, m_globalData.kt, "v")) {
-                PARSE_ERROR(e);
+                PARSE_ERROR(reader);
                 return false;
             }
         }
-        childNode = childNode.nextSibling();
+        reader.skipCurrentElement();
     }
 
     return true;
@@ -330,10 +351,9 @@ bool ScenefileReader::parseGlobalData(const QDomElement &globaldata) {
 /**
  * Parse a <lightdata> tag and add a new CS123SceneLightData to m_lights.
  */
-bool ScenefileReader::parseLightData(const QDomElement &lightdata) {
+bool ScenefileReader::parseLightData(QXmlStreamReader &reader) {
     // Create a default light
-    SceneLightData* light = new SceneLightData();
-    m_lights.push_back(light);
+    SceneLightData* light = &m_lights.emplace_back();
     memset(light, 0, sizeof(SceneLightData));
     light->pos = glm::vec4(3.f, 3.f, 3.f, 1.f);
     light->dir = glm::vec4(0.f, 0.f, 0.f, 0.f);
@@ -341,98 +361,97 @@ bool ScenefileReader::parseLightData(const QDomElement &lightdata) {
     light->function = glm::vec3(1, 0, 0);
 
     // Iterate over child elements
-    QDomNode childNode = lightdata.firstChild();
-    while (!childNode.isNull()) {
-        QDomElement e = childNode.toElement();
-        if (e.tagName() == "id") {
+    while (reader.readNextStartElement()) {
+        QXmlStreamAttributes e = reader.attributes();
+        if (reader.name() == u"id") {
             if (!parseInt(e, light->id, "v")) {
-                PARSE_ERROR(e);
+                PARSE_ERROR(reader);
                 return false;
             }
-        } else if (e.tagName() == "type") {
+        } else if (reader.name() == u"type") {
             if (!e.hasAttribute("v")) {
-                PARSE_ERROR(e);
+                PARSE_ERROR(reader);
                 return false;
             }
-            if (e.attribute("v") == "directional") light->type = LightType::LIGHT_DIRECTIONAL;
-            else if (e.attribute("v") == "point") light->type = LightType::LIGHT_POINT;
-            else if (e.attribute("v") == "spot") light->type = LightType::LIGHT_SPOT;
-            else if (e.attribute("v") == "area") light->type = LightType::LIGHT_AREA;
+            if (e.value("v") == u"directional") light->type = LightType::LIGHT_DIRECTIONAL;
+            else if (e.value("v") == u"point") light->type = LightType::LIGHT_POINT;
+            else if (e.value("v") == u"spot") light->type = LightType::LIGHT_SPOT;
+            else if (e.value("v") == u"area") light->type = LightType::LIGHT_AREA;
             else {
-                std::cout << ERROR_AT(e) << "unknown light type " << e.attribute("v").toStdString() << std::endl;
+                std::cout << ERROR_AT(reader) << "unknown light type " << e.value("v").toString().toStdString() << std::endl;
                 return false;
             }
-        } else if (e.tagName() == "color") {
+        } else if (reader.name() == u"color") {
             if (!parseColor(e, light->color)) {
-                PARSE_ERROR(e);
+                PARSE_ERROR(reader);
                 return false;
             }
-        } else if (e.tagName() == "function") {
+        } else if (reader.name() == u"function") {
             if (!parseTriple(e, light->function.x, light->function.y, light->function.z, "a", "b", "c") &&
                 !parseTriple(e, light->function.x, light->function.y, light->function.z, "x", "y", "z") &&
                 !parseTriple(e, light->function.x, light->function.y, light->function.z, "v1", "v2", "v3")) {
-                PARSE_ERROR(e);
+                PARSE_ERROR(reader);
                 return false;
             }
-        } else if (e.tagName() == "position") {
+        } else if (reader.name() == u"position") {
             if (light->type == LightType::LIGHT_DIRECTIONAL) {
-                std::cout << ERROR_AT(e) << "position is not applicable to directional lights" << std::endl;
+                std::cout << ERROR_AT(reader) << "position is not applicable to directional lights" << std::endl;
                 return false;
             }
             if (!parseTriple(e, light->pos.x, light->pos.y, light->pos.z, "x", "y", "z")) {
-                PARSE_ERROR(e);
+                PARSE_ERROR(reader);
                 return false;
             }
-        } else if (e.tagName() == "direction") {
+        } else if (reader.name() == u"direction") {
             if (light->type == LightType::LIGHT_POINT) {
-                std::cout << ERROR_AT(e) << "direction is not applicable to point lights" << std::endl;
+                std::cout << ERROR_AT(reader) << "direction is not applicable to point lights" << std::endl;
                 return false;
             }
             if (!parseTriple(e, light->dir.x, light->dir.y, light->dir.z, "x", "y", "z")) {
-                PARSE_ERROR(e);
+                PARSE_ERROR(reader);
                 return false;
             }
-        } else if (e.tagName() == "penumbra") {
+        } else if (reader.name() == u"penumbra") {
             if (light->type != LightType::LIGHT_SPOT) {
-                std::cout << ERROR_AT(e) << "penumbra is only applicable to spot lights" << std::endl;
+                std::cout << ERROR_AT(reader) << "penumbra is only applicable to spot lights" << std::endl;
                 return false;
             }
             if (!parseSingle(e, light->penumbra, "v")) {
-                PARSE_ERROR(e);
+                PARSE_ERROR(reader);
                 return false;
             }
-        } else if (e.tagName() == "angle") {
+        } else if (reader.name() == u"angle") {
             if (light->type != LightType::LIGHT_SPOT) {
-                std::cout << ERROR_AT(e) << "angle is only applicable to spot lights" << std::endl;
+                std::cout << ERROR_AT(reader) << "angle is only applicable to spot lights" << std::endl;
                 return false;
             }
             if (!parseSingle(e, light->angle, "v")) {
-                PARSE_ERROR(e);
+                PARSE_ERROR(reader);
                 return false;
             }
-        } else if (e.tagName() == "width") {
+        } else if (reader.name() == u"width") {
             if (light->type != LightType::LIGHT_AREA) {
-                std::cout << ERROR_AT(e) << "width is only applicable to area lights" << std::endl;
+                std::cout << ERROR_AT(reader) << "width is only applicable to area lights" << std::endl;
                 return false;
             }
             if (!parseSingle(e, light->width, "v")) {
-                PARSE_ERROR(e);
+                PARSE_ERROR(reader);
                 return false;
             }
-        } else if (e.tagName() == "height") {
+        } else if (reader.name() == u"height") {
             if (light->type != LightType::LIGHT_AREA) {
-                std::cout << ERROR_AT(e) << "height is only applicable to area lights" << std::endl;
+                std::cout << ERROR_AT(reader) << "height is only applicable to area lights" << std::endl;
                 return false;
             }
             if (!parseSingle(e, light->height, "v")) {
-                PARSE_ERROR(e);
+                PARSE_ERROR(reader);
                 return false;
             }
-        } else if (!e.isNull()) {
-            UNSUPPORTED_ELEMENT(e);
+        } else {
+            UNSUPPORTED_ELEMENT(reader);
             return false;
         }
-        childNode = childNode.nextSibling();
+        reader.skipCurrentElement();
     }
 
     return true;
@@ -441,27 +460,26 @@ bool ScenefileReader::parseLightData(const QDomElement &lightdata) {
 /**
  * Parse a <cameradata> tag and fill in m_cameraData.
  */
-bool ScenefileReader::parseCameraData(const QDomElement &cameradata) {
+bool ScenefileReader::parseCameraData(QXmlStreamReader &reader) {
     bool focusFound = false;
     bool lookFound = false;
 
     // Iterate over child elements
-    QDomNode childNode = cameradata.firstChild();
-    while (!childNode.isNull()) {
-        QDomElement e = childNode.toElement();
-        if (e.tagName() == "pos") {
+    while (reader.readNextStartElement()) {
+        QXmlStreamAttributes e = reader.attributes();
+        if (reader.name() == u"pos") {
             if (!parseTriple(e, m_cameraData.pos.x, m_cameraData.pos.y, m_cameraData.pos.z, "x", "y", "z")) {
-                PARSE_ERROR(e);
+                PARSE_ERROR(reader);
                 return false;
             }
             m_cameraData.pos.w = 1;
-        } else if (e.tagName() == "look" || e.tagName() == "focus") {
+        } else if (reader.name() == u"look" || reader.name() == u"focus") {
             if (!parseTriple(e, m_cameraData.look.x, m_cameraData.look.y, m_cameraData.look.z, "x", "y", "z")) {
-                PARSE_ERROR(e);
+                PARSE_ERROR(reader);
                 return false;
             }
 
-            if (e.tagName() == "focus") {
+            if (reader.name() == u"focus") {
                 // Store the focus point in the look vector (we will later subtract
                 // the camera position from this to get the actual look vector)
                 m_cameraData.look.w = 1;
@@ -471,42 +489,42 @@ bool ScenefileReader::parseCameraData(const QDomElement &cameradata) {
                 m_cameraData.look.w = 0;
                 lookFound = true;
             }
-        } else if (e.tagName() == "up") {
+        } else if (reader.name() == u"up") {
             if (!parseTriple(e, m_cameraData.up.x, m_cameraData.up.y, m_cameraData.up.z, "x", "y", "z")) {
-                PARSE_ERROR(e);
+                PARSE_ERROR(reader);
                 return false;
             }
             m_cameraData.up.w = 0;
-        } else if (e.tagName() == "heightangle") {
+        } else if (reader.name() == u"heightangle") {
             if (!parseSingle(e, m_cameraData.heightAngle, "v")) {
-                PARSE_ERROR(e);
+                PARSE_ERROR(reader);
                 return false;
             }
-        } else if (e.tagName() == "aspectratio") {
+        } else if (reader.name() == u"aspectratio") {
             if (!parseSingle(e, m_cameraData.aspectRatio, "v"))
             {
-                PARSE_ERROR(e);
+                PARSE_ERROR(reader);
                 return false;
             }
-        } else if (e.tagName() == "aperture") {
+        } else if (reader.name() == u"aperture") {
             if (!parseSingle(e, m_cameraData.aperture, "v")) {
-                PARSE_ERROR(e);
+                PARSE_ERROR(reader);
                 return false;
             }
-        } else if (e.tagName() == "focallength") {
+        } else if (reader.name() == u"focallength") {
             if (!parseSingle(e, m_cameraData.focalLength, "v")) {
-                PARSE_ERROR(e);
+                PARSE_ERROR(reader);
                 return false;
             }
-        } else if (!e.isNull()) {
-            UNSUPPORTED_ELEMENT(e);
+        } else {
+            UNSUPPORTED_ELEMENT(reader);
             return false;
         }
-        childNode = childNode.nextSibling();
+        reader.skipCurrentElement();
     }
 
     if (focusFound && lookFound) {
-        std::cout << ERROR_AT(cameradata) << "camera can not have both look and focus" << std::endl;
+        std::cout << ERROR_AT(reader) << "camera can not have both look and focus" << std::endl;
         return false;
     }
 
@@ -520,49 +538,45 @@ bool ScenefileReader::parseCameraData(const QDomElement &cameradata) {
 }
 
 /**
- * Parse an <object> tag and create a new CS123SceneNode in m_nodes.
+ * Parse an <object> tag and create a new CS123SceneNode in the arena.
  */
-bool ScenefileReader::parseObjectData(const QDomElement &object) {
+bool ScenefileReader::parseObjectData(QXmlStreamReader &reader) {
+    QXmlStreamAttributes object = reader.attributes();
     if (!object.hasAttribute("name")) {
-        PARSE_ERROR(object);
+        PARSE_ERROR(reader);
         return false;
     }
 
-    if (object.attribute("type") != "tree") {
+    if (object.value("type") != u"tree") {
         std::cout << "top-level <object> elements must be of type tree" << std::endl;
         return false;
     }
 
-    std::string name = object.attribute("name").toStdString();
+    std::string name = object.value("name").toString().toStdString();
 
     // Check that this object does not exist
     if (m_objects[name]) {
-        std::cout << ERROR_AT(object) << "two objects with the same name: " << name << std::endl;
+        std::cout << ERROR_AT(reader) << "two objects with the same name: " << name << std::endl;
         return false;
     }
 
     // Create the object and add to the map
-    SceneNode *node = new SceneNode;
-    m_nodes.push_back(node);
+    SceneNode *node = createNode();
     m_objects[name] = node;
 
     // Iterate over child elements
-    QDomNode childNode = object.firstChild();
-    while (!childNode.isNull()) {
-        QDomElement e = childNode.toElement();
-        if (e.tagName() == "transblock") {
-            SceneNode *child = new SceneNode;
-            m_nodes.push_back(child);
-            if (!parseTransBlock(e, child)) {
-                PARSE_ERROR(e);
+    while (reader.readNextStartElement()) {
+        if (reader.name() == u"transblock") {
+            SceneNode *child = createNode();
+            if (!parseTransBlock(reader, child)) {
+                PARSE_ERROR(reader);
                 return false;
             }
             node->children.push_back(child);
-        } else if (!e.isNull()) {
-            UNSUPPORTED_ELEMENT(e);
+        } else {
+            UNSUPPORTED_ELEMENT(reader);
             return false;
         }
-        childNode = childNode.nextSibling();
     }
 
     return true;
@@ -582,91 +596,85 @@ bool ScenefileReader::parseObjectData(const QDomElement &object) {
  *   <object type="primitive" name="sphere"/>
  * </transblock>
  */
-bool ScenefileReader::parseTransBlock(const QDomElement &transblock, SceneNode* node) {
+bool ScenefileReader::parseTransBlock(QXmlStreamReader &reader, SceneNode* node) {
     // Iterate over child elements
-    QDomNode childNode = transblock.firstChild();
-    while (!childNode.isNull()) {
-        QDomElement e = childNode.toElement();
-        if (e.tagName() == "translate") {
-            SceneTransformation *t = new SceneTransformation();
-            node->transformations.push_back(t);
-            t->type = TRANSFORMATION_TRANSLATE;
+    while (reader.readNextStartElement()) {
+        QXmlStreamAttributes e = reader.attributes();
+        if (reader.name() == u"translate") {
+            SceneTransformation &t = node->transformations.emplace_back();
+            t.type = TRANSFORMATION_TRANSLATE;
 
-            if (!parseTriple(e, t->translate.x, t->translate.y, t->translate.z, "x", "y", "z")) {
-                PARSE_ERROR(e);
+            if (!parseTriple(e, t.translate.x, t.translate.y, t.translate.z, "x", "y", "z")) {
+                PARSE_ERROR(reader);
                 return false;
             }
-        } else if (e.tagName() == "rotate") {
-            SceneTransformation *t = new SceneTransformation();
-            node->transformations.push_back(t);
-            t->type = TRANSFORMATION_ROTATE;
+            reader.skipCurrentElement();
+        } else if (reader.name() == u"rotate") {
+            SceneTransformation &t = node->transformations.emplace_back();
+            t.type = TRANSFORMATION_ROTATE;
 
             float angle;
-            if (!parseQuadruple(e, t->rotate.x, t->rotate.y, t->rotate.z, angle, "x", "y", "z", "angle")) {
-                PARSE_ERROR(e);
+            if (!parseQuadruple(e, t.rotate.x, t.rotate.y, t.rotate.z, angle, "x", "y", "z", "angle")) {
+                PARSE_ERROR(reader);
                 return false;
             }
 
             // Convert to radians
-            t->angle = angle * M_PI / 180;
-        } else if (e.tagName() == "scale") {
-            SceneTransformation *t = new SceneTransformation();
-            node->transformations.push_back(t);
-            t->type = TRANSFORMATION_SCALE;
+            t.angle = angle * M_PI / 180;
+            reader.skipCurrentElement();
+        } else if (reader.name() == u"scale") {
+            SceneTransformation &t = node->transformations.emplace_back();
+            t.type = TRANSFORMATION_SCALE;
 
-            if (!parseTriple(e, t->scale.x, t->scale.y, t->scale.z, "x", "y", "z")) {
-                PARSE_ERROR(e);
+            if (!parseTriple(e, t.scale.x, t.scale.y, t.scale.z, "x", "y", "z")) {
+                PARSE_ERROR(reader);
                 return false;
             }
-        } else if (e.tagName() == "matrix") {
-            SceneTransformation* t = new SceneTransformation();
-            node->transformations.push_back(t);
-            t->type = TRANSFORMATION_MATRIX;
+            reader.skipCurrentElement();
+        } else if (reader.name() == u"matrix") {
+            SceneTransformation &t = node->transformations.emplace_back();
+            t.type = TRANSFORMATION_MATRIX;
 
-            if (!parseMatrix(e, t->matrix)) {
-                PARSE_ERROR(e);
+            if (!parseMatrix(reader, t.matrix)) {
+                PARSE_ERROR(reader);
                 return false;
             }
-        } else if (e.tagName() == "object") {
-            if (e.attribute("type") == "master") {
-                std::string masterName = e.attribute("name").toStdString();
+        } else if (reader.name() == u"object") {
+            if (e.value("type") == u"master") {
+                std::string masterName = e.value("name").toString().toStdString();
                 if (!m_objects[masterName]) {
-                    std::cout << ERROR_AT(e) << "invalid master object reference: " << masterName << std::endl;
+                    std::cout << ERROR_AT(reader) << "invalid master object reference: " << masterName << std::endl;
                     return false;
                 }
                 node->children.push_back(m_objects[masterName]);
-            } else if (e.attribute("type") == "tree") {
-                QDomNode subNode = e.firstChild();
-                while (!subNode.isNull()) {
-                    QDomElement e = subNode.toElement();
-                    if (e.tagName() == "transblock") {
-                        SceneNode* n = new SceneNode;
-                        m_nodes.push_back(n);
+                reader.skipCurrentElement();
+            } else if (e.value("type") == u"tree") {
+                while (reader.readNextStartElement()) {
+                    if (reader.name() == u"transblock") {
+                        SceneNode* n = createNode();
                         node->children.push_back(n);
-                        if (!parseTransBlock(e, n)) {
-                            PARSE_ERROR(e);
+                        if (!parseTransBlock(reader, n)) {
+                            PARSE_ERROR(reader);
                             return false;
                         }
-                    } else if (!e.isNull()) {
-                        UNSUPPORTED_ELEMENT(e);
+                    } else {
+                        UNSUPPORTED_ELEMENT(reader);
                         return false;
                     }
-                    subNode = subNode.nextSibling();
                 }
-            } else if (e.attribute("type") == "primitive") {
-                if (!parsePrimitive(e, node)) {
-                    PARSE_ERROR(e);
+            } else if (e.value("type") == u"primitive") {
+                if (!parsePrimitive(reader, node)) {
+                    PARSE_ERROR(reader);
                     return false;
                 }
             } else {
-                std::cout << ERROR_AT(e) << "invalid object type: " << e.attribute("type").toStdString() << std::endl;
+                std::cout << ERROR_AT(reader) << "invalid object type: " << e.value("type").toString().toStdString() << std::endl;
                 return false;
             }
-        } else if (!e.isNull()) {
-            UNSUPPORTED_ELEMENT(e);
+        } else {
+            UNSUPPORTED_ELEMENT(reader);
             return false;
         }
-        childNode = childNode.nextSibling();
     }
 
     return true;
@@ -675,9 +683,12 @@ bool ScenefileReader::parseTransBlock(const QDomElement &transblock, SceneNode*
 /**
  * Parse an <object type="primitive"> tag into node.
  */
-bool ScenefileReader::parsePrimitive(const QDomElement &prim, SceneNode* node) {
+bool ScenefileReader::parsePrimitive(QXmlStreamReader &reader, SceneNode* node) {
+    QXmlStreamAttributes prim = reader.attributes();
+
     // Default primitive
-    ScenePrimitive* primitive = new ScenePrimitive();
+    ScenePrimitive* primitive = m_allocator.new_object<ScenePrimitive>();
+    m_primitives.push_back(primitive);
     SceneMaterial& mat = primitive->material;
     mat.clear();
     primitive->type = PrimitiveType::PRIMITIVE_CUBE;
@@ -687,7 +698,7 @@ bool ScenefileReader::parsePrimitive(const QDomElement &prim, SceneNode* node) {
     node->primitives.push_back(primitive);
 
     // Parse primitive type
-    std::string primType = prim.attribute("name").toStdString();
+    std::string primType = prim.value("name").toString().toStdString();
     if (primType == "sphere") primitive->type = PrimitiveType::PRIMITIVE_SPHERE;
     else if (primType == "cube") primitive->type = PrimitiveType::PRIMITIVE_CUBE;
     else if (primType == "cylinder") primitive->type = PrimitiveType::PRIMITIVE_CYLINDER;
@@ -696,9 +707,9 @@ bool ScenefileReader::parsePrimitive(const QDomElement &prim, SceneNode* node) {
     else if (primType == "mesh") {
         primitive->type = PrimitiveType::PRIMITIVE_MESH;
         if (prim.hasAttribute("meshfile")) {
-            primitive->meshfile = prim.attribute("meshfile").toStdString();
+            primitive->meshfile = prim.value("meshfile").toString().toStdString();
         } else if (prim.hasAttribute("filename")) {
-            primitive->meshfile = prim.attribute("filename").toStdString();
+            primitive->meshfile = prim.value("filename").toString().toStdString();
         } else {
             std::cout << "mesh object must specify filename" << std::endl;
             return false;
@@ -706,69 +717,68 @@ bool ScenefileReader::parsePrimitive(const QDomElement &prim, SceneNode* node) {
     }
 
     // Iterate over child elements
-    QDomNode childNode = prim.firstChild();
-    while (!childNode.isNull()) {
-        QDomElement e = childNode.toElement();
-        if (e.tagName() == "diffuse") {
+    while (reader.readNextStartElement()) {
+        QXmlStreamAttributes e = reader.attributes();
+        if (reader.name() == u"diffuse") {
             if (!parseColor(e, mat.cDiffuse)) {
-                PARSE_ERROR(e);
+                PARSE_ERROR(reader);
                 return false;
             }
-        } else if (e.tagName() == "ambient") {
+        } else if (reader.name() == u"ambient") {
             if (!parseColor(e, mat.cAmbient)) {
-                PARSE_ERROR(e);
+                PARSE_ERROR(reader);
                 return false;
             }
-        } else if (e.tagName() == "reflective") {
+        } else if (reader.name() == u"reflective") {
             if (!parseColor(e, mat.cReflective)) {
-                PARSE_ERROR(e);
+                PARSE_ERROR(reader);
                 return false;
             }
-        } else if (e.tagName() == "specular") {
+        } else if (reader.name() == u"specular") {
             if (!parseColor(e, mat.cSpecular)) {
-                PARSE_ERROR(e);
+                PARSE_ERROR(reader);
                 return false;
             }
-        } else if (e.tagName() == "emissive") {
+        } else if (reader.name() == u"emissive") {
             if (!parseColor(e, mat.cEmissive)) {
-                PARSE_ERROR(e);
+                PARSE_ERROR(reader);
                 return false;
             }
-        } else if (e.tagName() == "transparent") {
+        } else if (reader.name() == u"transparent") {
             if (!parseColor(e, mat.cTransparent)) {
-                PARSE_ERROR(e);
+                PARSE_ERROR(reader);
                 return false;
             }
-        } else if (e.tagName() == "shininess") {
+        } else if (reader.name() == u"shininess") {
             if (!parseSingle(e, mat.shininess, "v")) {
-                PARSE_ERROR(e);
+                PARSE_ERROR(reader);
                 return false;
             }
-        } else if (e.tagName() == "ior") {
+        } else if (reader.name() == u"ior") {
             if (!parseSingle(e, mat.ior, "v")) {
-                PARSE_ERROR(e);
+                PARSE_ERROR(reader);
                 return false;
             }
-        } else if (e.tagName() == "texture") {
+        } else if (reader.name() == u"texture") {
             if (!parseMap(e, mat.textureMap)) {
-                PARSE_ERROR(e);
+                PARSE_ERROR(reader);
                 return false;
             }
-        } else if (e.tagName() == "bumpmap") {
+        } else if (reader.name() == u"bumpmap") {
             if (!parseMap(e, mat.bumpMap)) {
-                PARSE_ERROR(e);
+                PARSE_ERROR(reader);
                 return false;
             }
-        } else if (e.tagName() == "blend") {
+        } else if (reader.name() == u"blend") {
             if (!parseSingle(e, mat.blend, "v")) {
-                PARSE_ERROR(e);
+                PARSE_ERROR(reader);
                 return false;
             }
         } else {
-            UNSUPPORTED_ELEMENT(e);
+            UNSUPPORTED_ELEMENT(reader);
             return false;
         }
-        childNode = childNode.nextSibling();
+        reader.skipCurrentElement();
     }
 
     return true;
@@ -5,8 +5,38 @@
 
 #include <vector>
 #include <map>
+#include <memory_resource>
 
-#include <QDomDocument>
+#include <QXmlStreamReader>
+
+struct SceneParseStatistics {
+    qint64 bytes = 0;
+    double seconds = 0;
+
+    size_t nodes = 0;
+    size_t arenaAllocations = 0;  // Requests served by the scene graph arena
+    size_t heapAllocations = 0;   // Blocks the arena obtained from the heap
+    size_t heapBytes = 0;
+
+    // Parse throughput in MB/s
+    double throughput() const { return seconds > 0 ? bytes / 1048576. / seconds : 0; }
+};
+
+// Forwards to an upstream resource and counts what passes through it.
+class CountingMemoryResource : public std::pmr::memory_resource {
+public:
+    explicit CountingMemoryResource(std::pmr::memory_resource* upstream) : m_upstream(upstream) {}
+
+    size_t allocations = 0;
+    size_t bytes = 0;
+
+private:
+    void* do_allocate(size_t size, size_t alignment) override;
+    void do_deallocate(void* p, size_t size, size_t alignment) override;
+    bool do_is_equal(const std::pmr::memory_resource& other) const noexcept override;
+
+    std::pmr::memory_resource* m_upstream;
+};
 
 /**
  * @class ScenefileReader
@@ -14,7 +44,12 @@
  * This class parses the scene graph specified by the CS123 Xml file format.
  *
  * The parser is designed to replace the TinyXML parser that was in turn designed to replace the
- * Flex/Yacc/Bison parser.
+ * Flex/Yacc/Bison parser. The file is read through a QXmlStreamReader in a single forward pass,
+ * so no DOM is held in memory while the scene graph is built.
+ *
+ * Nodes, primitives and lights are carved out of a monotonic arena owned by the reader, and
+ * transformations are stored inline in their nodes. The whole graph is released in bulk when
+ * the reader is destroyed.
  */
 
 class ScenefileReader {
@@ -40,22 +75,39 @@ public:
 
     SceneNode* getRootNode() const;
 
+    // Size and timing of the last readXML() call
+    const SceneParseStatistics& getParseStatistics() const;
+
 private:
     // The filename should be contained within this parser implementation.
     // If you want to parse a new file, instantiate a different parser.
-    bool parseGlobalData(const QDomElement &globaldata);
-    bool parseCameraData(const QDomElement &cameradata);
-    bool parseLightData(const QDomElement &lightdata);
-    bool parseObjectData(const QDomElement &object);
-    bool parseTransBlock(const QDomElement &transblock, SceneNode* node);
-    bool parsePrimitive(const QDomElement &prim, SceneNode* node);
+    // Each of these is entered with the reader positioned on the start tag of its element
+    // and returns with the reader positioned on the matching end tag.
+    bool parseGlobalData(QXmlStreamReader &reader);
+    bool parseCameraData(QXmlStreamReader &reader);
+    bool parseLightData(QXmlStreamReader &reader);
+    bool parseObjectData(QXmlStreamReader &reader);
+    bool parseTransBlock(QXmlStreamReader &reader, SceneNode* node);
+    bool parsePrimitive(QXmlStreamReader &reader, SceneNode* node);
+
+    // Create a node whose lists are allocated from the arena
+    SceneNode* createNode();
+
+    // Scene graph storage: heap blocks are counted as they enter the arena, and requests are
+    // counted as the arena serves them. These must outlive everything allocated below.
+    CountingMemoryResource m_heap{ std::pmr::new_delete_resource() };
+    std::pmr::monotonic_buffer_resource m_arena{ &m_heap };
+    CountingMemoryResource m_arenaRequests{ &m_arena };
+    std::pmr::polymorphic_allocator<> m_allocator{ &m_arenaRequests };
 
     std::string file_name;
     mutable std::map<std::string, SceneNode*> m_objects;
     SceneGlobalData m_globalData;
     SceneCameraData m_cameraData;
-    std::vector<SceneLightData*> m_lights;
-    std::vector<SceneNode*> m_nodes;
+    std::pmr::vector<SceneLightData> m_lights{ m_allocator };
+    // Primitives own their filename strings, so they are the only objects destroyed individually
+    std::pmr::vector<ScenePrimitive*> m_primitives{ m_allocator };
+    SceneParseStatistics m_parseStatistics;
 };
 
 #endif
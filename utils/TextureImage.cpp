@@ -0,0 +1,24 @@
+#include "TextureImage.h"
+
+#include <cstring>
+#include <iostream>
+
+#include <QImage>
+
+bool TextureImage::load(const std::string& filepath) {
+    QImage image(QString::fromStdString(filepath));
+    if (image.isNull()) {
+        std::cout << "could not load texture " << filepath << ", rendering without it" << std::endl;
+        return false;
+    }
+
+    image = image.convertToFormat(QImage::Format_RGBA8888);
+    width = image.width();
+    height = image.height();
+    pixels.resize(static_cast<std::size_t>(width) * height);
+    for (int y = 0; y < height; y++)
+        std::memcpy(&pixels[static_cast<std::size_t>(y) * width], image.constScanLine(y), width * sizeof(RGBA));
+
+    std::cout << "loaded texture " << filepath << " (" << width << "x" << height << ")" << std::endl;
+    return true;
+}
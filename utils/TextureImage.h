@@ -0,0 +1,26 @@
+#ifndef TEXTUREIMAGE_H
+#define TEXTUREIMAGE_H
+
+#include <string>
+#include <vector>
+
+#include "RGBA.h"
+
+/**
+ * @class TextureImage
+ *
+ * An image file decoded to 8-bit RGBA pixels, row by row from the top. Anything QImage can
+ * read is accepted; the pixels are left sRGB encoded, it is up to the renderer to linearize
+ * them and build whatever it samples from.
+ */
+class TextureImage {
+public:
+    // Decode filepath. Returns false if the file is missing or not a readable image.
+    bool load(const std::string& filepath);
+
+    int width = 0;
+    int height = 0;
+    std::vector<RGBA> pixels;
+};
+
+#endif // TEXTUREIMAGE_H